@@ -10,7 +10,14 @@
 #include <string_view>
 #include <sstream>
 #include <iostream>
-#include <regex>
+#include <array>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <algorithm>
 #include <cstdlib>
@@ -22,29 +29,399 @@
 /* Local dependencies */
 #include "DailyQA.h"
 
-//Returns the floating-point value of click rate percentage (format: "x.xx%" -> x.xx)
-static constexpr double find_threshold(auto const& rate)
+//One percent in fixed-point (see DailyQA::fixed)
+static constexpr std::int32_t fixed_scale = 1000000;
+
+//Largest whole number of percent kept by parse_percent() (larger values saturate)
+static constexpr std::int32_t max_percent = 1000;
+
+//Parses the leading number of a percentage the way std::stod did ("10.055%" -> 10.055 percent, " 9.5" -> 9.5 percent)
+//into fixed-point. "n/a" reads as 0. Digits past the sixth decimal are dropped and the whole part saturates
+//at max_percent, so any two values differ by less than 2^31. Returns false if there is no number.
+static constexpr bool parse_percent(cell s, std::int32_t& out)
+{
+    if(s == "n/a") { out = 0; return true; }
+
+    std::size_t i = 0;
+    while(i < s.size() && (s[i] == ' ' || (s[i] >= '\t' && s[i] <= '\r'))) ++i;
+    bool negative = i < s.size() && s[i] == '-';
+    if(i < s.size() && (s[i] == '-' || s[i] == '+')) ++i;
+
+    bool digits = false;
+    std::int32_t whole = 0, frac = 0, place = fixed_scale;
+    for(; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i, digits = true)
+        whole = std::min(whole*10 + (s[i] - '0'), max_percent);
+    if(i < s.size() && s[i] == '.')
+        for(++i; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i, digits = true)
+            if(place > 1) { place /= 10; frac += (s[i] - '0')*place; }
+    if(!digits) return false;
+
+    out = (whole*fixed_scale + frac) * (negative? -1 : 1);
+    return true;
+}
+
+//Threshold check of n projects: the verdict (see DailyQA::Verdict) is Pass if both thresholds are above
+//both click rates, otherwise Fail. A threshold state (Err, NoThreshold) wins over a click rate state (Err),
+//either wins over the comparison. Both states have bit 1 set, so this is all bitwise and branch-free.
+//Runs in blocks of fixed length, which GCC vectorizes even at -O2 (not inlined, which would lose __restrict).
+[[gnu::noinline]] static void check_thresholds(std::size_t n, std::int32_t const* __restrict t1, std::int32_t const* __restrict t2,
+                             std::uint8_t const* __restrict ts, std::int32_t const* __restrict r1,
+                             std::int32_t const* __restrict r2, std::uint8_t const* __restrict rs, std::uint8_t* __restrict out)
+{
+    auto check = [&](std::size_t i)
+    {
+        //Sign bit of r - t is set when t > r (no overflow, parse_percent() saturates)
+        std::uint32_t d1 = std::uint32_t(r1[i]) - std::uint32_t(t1[i]), d2 = std::uint32_t(r2[i]) - std::uint32_t(t2[i]);
+        std::uint8_t forced = ts[i] | rs[i];
+        out[i] = forced | (std::uint8_t((d1 & d2) >> 31) & ~(forced >> 1));
+    };
+
+    constexpr std::size_t block = 16;
+    std::size_t i = 0;
+    for(; i + block <= n; i += block)
+        for(std::size_t j = 0; j < block; ++j) check(i + j);
+    for(; i < n; ++i) check(i);
+}
+
+//Carrier columns of the throughput sheet (see DailyQA::carrier)
+static constexpr std::array<std::size_t, 4> carrier_columns{6, 7, 8, 9};
+
+//Each line of throughput sheet has 10 cells
+static constexpr std::size_t throughput_cells = 10;
+
+//Largest provider code kept in the dense provider table (larger codes and codes with leading zeros go to DailyQA::provider_overflow)
+static constexpr unsigned max_provider_code = 9999;
+
+//Value of a provider code made of digits only, saturated at max_provider_code + 1
+static constexpr unsigned provider_code(cell digits)
 {
-    return std::stod(rate == "n/a"?"0.0":rate.substr(0,'%')); //(std::stod(_7v) + std::stod(_3v) + std::stod(_2v) + std::stod(_1v))/4;
+    unsigned code = 0;
+    for(char c : digits) code = std::min(code*10 + (c - '0'), max_provider_code + 1);
+    return code;
 }
 
-DailyQA::DailyQA(std::string_view names, std::string_view data, std::string_view throughput, std::string_view providers, std::string_view thresholds,
-                 std::string_view evening_data, std::string_view afternoon_data)
-         : names_sheet{names.data()},
-           morning_sheet{data.data()},
-           throughput_sheet{throughput.data(), 10}, //Each line of throughput sheet has 10 cells
-           providers_sheet{providers.data()},
-           threshold_sheet{thresholds.data(), 4},
-           evening_sheet{evening_data.data(), 7},
-           afternoon_sheet{afternoon_data.data(), 7}
+//Hand-written scanner for the provider code N of a throughput carrier cell ("(N) phone (rate%)"). Accepts
+//the same cells as the regex \(([0-9]+)\).+ did. The rest of the cell is never needed, so it is not parsed.
+static constexpr bool carrier_code(cell dat, cell& code)
+{
+    if(dat.size() < 4 || dat[0] != '(') return false;
+
+    std::size_t i = 1;
+    while(i < dat.size() && dat[i] >= '0' && dat[i] <= '9') ++i;
+    if(i == 1 || i + 1 >= dat.size() || dat[i] != ')') return false;
+    if(dat.find_first_of("\r\n", i + 1) != cell::npos) return false;
+
+    code = dat.substr(1, i - 1);
+    return true;
+}
+
+DailyQA::DailyQA(Files files) : files{std::move(files)}, pool{std::make_unique<ThreadPool>(sheet_count)} {}
+
+DailyQA::DailyQA(Files files, DailyQA const& shared)
+         : files{std::move(files)},
+           keys{shared.keys},
+           provider_entries{shared.provider_entries},
+           provider_overflow{shared.provider_overflow},
+           threshold_entries{shared.threshold_entries},
+           shared_metrics{shared.metrics}
+{
+    for(auto s : {Names, Thresholds, Providers}) sheets[s] = shared.sheets[s];
+}
 
+bool DailyQA::load(std::initializer_list<Sheet> needed)
 {
-    // Insert data into a hash map for easy lookup
-    for(auto&& line : providers_sheet) provider_entries.insert({line[0], {line[1], 0} });
+    //Open every file up front so that no parse is in flight if one is missing
+    std::array<std::optional<csv>, sheet_count> opened{};
+    for(auto s : needed)
+        if(!loaded(s))
+        {
+            Stopwatch timer{};
+            if(!opened[s].emplace(files.sheets[s])) { *errors << "could not open file " << files.sheets[s] << ".\n"; return false; }
+            metrics.parse_seconds[s] = timer.seconds();
+        }
+
+    //Independent sheets are parsed concurrently (each task only touches its own sheet's metrics)
+    auto parse = [this, &opened](Sheet s)
+    {
+        Stopwatch timer{};
+        sheets[s] = std::make_shared<Spreadsheet>(std::move(*opened[s]), line_lengths[s]);
+        metrics.parse_seconds[s] += timer.seconds();
+        metrics.rows[s] = sheets[s]->size();
+    };
+    std::vector<std::future<void>> pending{};
+    for(auto s : needed)
+        if(!opened[s]) continue;
+        else if(s == Throughput) throughput_csv = std::make_unique<csv>(std::move(*opened[s])); //Only mapped, scanned later
+        else if(pool) pending.push_back(pool->submit([parse, s]{ parse(s); }));
+        else parse(s);
+    for(auto&& f : pending) f.get();
+
+    if(sheets[Names] && !keys)
+    {
+        Stopwatch timer{};
+        keys = std::make_shared<KeyIndex const>(sheet(Names));
+        metrics.keys_seconds = timer.seconds();
+    }
+    if(sheets[Providers] && provider_entries.empty()) add_provider_entries();
+    if(sheets[Thresholds] && keys && threshold_entries.size() != keys->size())
+    {
+        Stopwatch timer{};
+        thresholds();
+        metrics.thresholds_seconds = timer.seconds();
+    }
+    return true;
+}
 
+DailyQA::ProviderEntry& DailyQA::find_provider(cell digits)
+{
+    //Codes are matched as spelled: "08" is not provider 8, so only codes without leading zeros are dense
+    auto code = provider_code(digits);
+    if(code > max_provider_code || (digits.size() > 1 && digits[0] == '0')) return provider_overflow[std::string{digits}];
+    if(code >= provider_entries.size()) provider_entries.resize(code + 1);
+    return provider_entries[code];
 }
 
-void DailyQA::run()
+void DailyQA::add_provider_entries()
+{
+    // Insert data into a table indexed by provider code for easy lookup
+    for(auto&& line : sheet(Providers))
+    {
+        auto c = line[0];
+        if(c.empty() || c.find_first_not_of("0123456789") != cell::npos)
+        {
+            *errors << "\u001b[31;1mERROR:\u001b[37;1m    " << c << "\u001b[0m is not a valid provider code\n";
+            continue;
+        }
+        auto& provider = find_provider(c);
+        if(provider.name == "") provider.name = line.size() > 1? line[1] : "UNKNOWN";
+    }
+}
+
+bool DailyQA::run(Stage s)
+{
+    //The first stage is charged with the shared load, as if it had parsed the reference sheets itself
+    metrics = std::exchange(shared_metrics, {});
+    Stopwatch stage{};
+
+    //Runs f, adding its wall time to the given metric
+    auto timed = [](double& seconds, auto&& f){ Stopwatch timer{}; f(); seconds += timer.seconds(); };
+
+    //A stage whose files are missing is still recorded, so that the run can be told apart from a skipped one
+    auto failed = [&]{ outfile.close(); t_outfile.close(); metrics.ok = false; metrics.seconds = stage.seconds(); write_metrics(s); return false; };
+
+    //Output files are required, a stage that cannot write its results fails
+    auto open = [this](std::ofstream& f, std::string const& name)
+    {
+        f.open(name);
+        if(!f) *errors << "\u001b[31;1mError: could not open \u001b[35;1m" << name << "\u001b[0m\n";
+        return bool(f);
+    };
+
+    switch(s)
+    {
+        case Stage::Morning:
+            if(!load({Names, Data, Thresholds, Throughput, Providers})) return failed();
+            if(!open(outfile, files.output[static_cast<std::size_t>(s)]) || !open(t_outfile, files.throughput)) return failed();
+            *console << "Formatting Morning QA sheet...\n\n";
+            timed(metrics.join_seconds, [&]{ add_entries(sheet(Data), morning_entries); add_click_rates(); });
+            timed(metrics.scan_seconds, [&]{ scan_throughput(); });
+            timed(metrics.qa_seconds,   [&]{ morning_QA(); });
+            *console << "\n\u001b[32;1mMorning QA Sheet successfully formatted.\u001b[0m\n ";
+
+            *console << "Formatting Throughput sheet...\n";
+            log.open(files.log);
+            timed(metrics.throughput_seconds, [&]{ throughput(); });
+            t_outfile.close();
+            log.close();
+            *console << "\u001b[32;1mDone.\u001b[0m\n\n";
+            break;
+        case Stage::Afternoon:
+            if(!load({Names, Afternoon})) return failed();
+            if(!open(outfile, files.output[static_cast<std::size_t>(s)])) return failed();
+            timed(metrics.join_seconds, [&]{ add_entries(sheet(Afternoon), afternoon_entries); });
+            *console << " Afternoon QA report:  \n";
+            timed(metrics.qa_seconds, [&]{ other_QA<1>(); });
+            *console << "\n\u001b[32;1mAfternoon QA Sheet successfully formatted.\u001b[0m\n ";
+            break;
+        case Stage::Evening:
+            if(!load({Names, Evening})) return failed();
+            if(!open(outfile, files.output[static_cast<std::size_t>(s)])) return failed();
+            timed(metrics.join_seconds, [&]{ add_entries(sheet(Evening), evening_entries); });
+            *console << " Evening QA report:  \n";
+            timed(metrics.qa_seconds, [&]{ other_QA<0>(); });
+            *console << "\n\u001b[32;1mEvening QA Sheet successfully formatted.\u001b[0m\n ";
+            break;
+    }
+    outfile.close();
+
+    metrics.seconds = stage.seconds();
+    write_metrics(s);
+    return true;
+}
+
+void DailyQA::write_metrics(Stage s) const
+{
+    std::ofstream out{files.metrics, std::ios::app};
+    if(!out) { *errors << "\u001b[31;1mError: could not open \u001b[35;1m" << files.metrics << "\u001b[0m\n"; return; }
+
+    out << "{\"time\":" << json_string{utc_timestamp()} << ",\"stage\":" << json_string{stage_names[static_cast<std::size_t>(s)]}
+        << ",\"ok\":" << (metrics.ok? "true" : "false") << ",\"seconds\":" << metrics.seconds;
+
+    //Only the sheets this stage had to parse
+    out << ",\"sheets\":{";
+    for(bool first = true; auto sh : {Names, Data, Throughput, Providers, Thresholds, Evening, Afternoon})
+    {
+        if(metrics.parse_seconds[sh] == 0.0) continue;
+        out << (first? "" : ",") << json_string{sheet_names[sh]} << ":{\"seconds\":" << metrics.parse_seconds[sh]
+            << ",\"rows\":" << (sh == Throughput && throughput_stats? throughput_stats->lines : metrics.rows[sh]) << '}';
+        first = false;
+    }
+    out << "},\"keys_seconds\":" << metrics.keys_seconds << ",\"thresholds_seconds\":" << metrics.thresholds_seconds
+        << ",\"join_seconds\":" << metrics.join_seconds << ",\"qa_seconds\":" << metrics.qa_seconds;
+
+    out << ",\"lookups\":{\"hits\":" << metrics.hits << ",\"misses\":" << metrics.misses << ",\"separators\":" << metrics.separators
+        << ",\"missing_thresholds\":" << metrics.missing_thresholds << ",\"bad_thresholds\":" << metrics.bad_thresholds
+        << ",\"bad_rates\":" << metrics.bad_rates << '}';
+
+    if(s == Stage::Morning && throughput_stats)
+    {
+        auto const& stats = *throughput_stats;
+        static constexpr std::string_view carrier_names[carrier_count] = {"att", "sprint", "tmobile", "verizon"};
+        auto per_carrier = [&](auto const& counts)
+        {
+            out.put('{');
+            for(std::size_t c = 0; c < carrier_count; ++c) out << (c? "," : "") << json_string{carrier_names[c]} << ':' << counts[c];
+            out.put('}');
+        };
+
+        out << ",\"scan_seconds\":" << metrics.scan_seconds << ",\"throughput_seconds\":" << metrics.throughput_seconds
+            << ",\"throughput\":{\"lines\":" << stats.lines << ",\"entries\":" << stats.total_entries
+            << ",\"deleted\":" << stats.lines - stats.total_entries << ",\"kept\":" << throughput_rows.size() << ",\"total\":";
+        per_carrier(stats.total);
+        out << ",\"only\":";
+        per_carrier(stats.only);
+        out << ",\"all\":" << stats.all << ",\"unknown_providers\":" << stats.unknown_providers << ",\"providers\":{";
+        bool first = true;
+        for_each_provider([&](auto const& code, ProviderEntry const& provider)
+        {
+            out << (first? "" : ",") << '"' << code << "\":{\"name\":" << json_string{provider.name} << ",\"blocks\":" << provider.count << '}';
+            first = false;
+        });
+        out << "}}";
+    }
+    out << "}\n";
+}
+
+cell DailyQA::click_rate(Stage s, std::size_t id)
+{
+    //Morning uses the 1 day only clicked rate, afternoon and evening the current click rate
+    auto [entries, data, column] = s == Stage::Morning?   std::tuple{&morning_entries,   Data,      10} :
+                                   s == Stage::Afternoon? std::tuple{&afternoon_entries, Afternoon, 2}  :
+                                                          std::tuple{&evening_entries,   Evening,   2};
+    if(!sheets[data] || id >= entries->size() || (*entries)[id] == npos) return "";
+    auto rate = sheet(data)[(*entries)[id]][column];
+    return rate == ""? "n/a" : rate;
+}
+
+bool DailyQA::backfill(Files const& files, std::string const& dir, std::string const& out_dir,
+                       std::vector<Stage> const& stages, unsigned threads)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    std::vector<std::string> dates{};
+    for(auto it = fs::directory_iterator{dir, ec}; !ec && it != fs::directory_iterator{}; it.increment(ec))
+        if(it->is_directory()) dates.push_back(it->path().filename().string());
+    if(ec) { std::cerr << "\u001b[31;1mERROR:\u001b[0m could not read \u001b[35;1m" << dir << "\u001b[0m: " << ec.message() << '\n'; return false; }
+    std::sort(std::begin(dates), std::end(dates));
+
+    //Reference sheets are parsed once and shared read-only by every date
+    DailyQA shared{files};
+    if(!shared.load({Names, Thresholds, Providers})) return false;
+
+    //Click rates of every date, indexed by key ID then stage
+    using Rates = std::vector<std::array<std::string, stage_count>>;
+    std::vector<Rates> trend(dates.size(), Rates(shared.keys->size()));
+    std::vector<char> failed(dates.size()); //Not vector<bool>, dates are marked concurrently
+    std::mutex console_mutex{};
+
+    {
+        ThreadPool workers{threads};
+        std::vector<std::future<void>> pending{};
+        for(std::size_t d = 0; d < dates.size(); ++d)
+            pending.push_back(workers.submit([&, d]
+            {
+                std::ostringstream messages{};
+
+                //A bad date is reported with its messages; the other dates and the trend table are still written
+                try
+                {
+                    auto in = fs::path{dir} / dates[d], out = fs::path{out_dir} / dates[d];
+                    fs::create_directories(out);
+
+                    //Dated sheets keep their usual file names
+                    Files day_files{files};
+                    for(auto s : {Data, Throughput, Evening, Afternoon}) day_files.sheets[s] = (in / fs::path{Files{}.sheets[s]}.filename()).string();
+                    for(std::size_t s = 0; s < stage_count; ++s) day_files.output[s] = (out / (std::string{stage_names[s]} + ".csv")).string();
+                    day_files.throughput = (out / "t_outfile.csv").string();
+                    day_files.log = (out / "log.csv").string();
+                    day_files.metrics = (out / "metrics.jsonl").string();
+
+                    DailyQA day{day_files, shared};
+                    day.console = day.errors = &messages;
+
+                    //Required sheets of each stage
+                    auto available = [&](Stage s)
+                    {
+                        auto exists = [&](Sheet sheet){ return fs::exists(day_files.sheets[sheet]); };
+                        return s == Stage::Morning?   exists(Data) && exists(Throughput) :
+                               s == Stage::Afternoon? exists(Afternoon) : exists(Evening);
+                    };
+                    for(std::size_t i = 0; i < stage_count; ++i)
+                    {
+                        auto s = static_cast<Stage>(i);
+                        if(!stages.empty() && std::find(std::begin(stages), std::end(stages), s) == std::end(stages)) continue;
+                        if(!available(s)) { messages << "Skipping " << stage_names[i] << " stage (missing input)\n"; continue; }
+
+                        if(!day.run(s)) { messages << "\u001b[31;1mERROR:\u001b[0m " << stage_names[i] << " stage failed\n"; failed[d] = true; continue; }
+                        for(std::size_t id = 0; id < trend[d].size(); ++id) trend[d][id][i] = day.click_rate(s, id);
+                    }
+                }
+                catch(std::exception const& e)
+                {
+                    messages << "\u001b[31;1mERROR:\u001b[0m " << e.what() << '\n';
+                    failed[d] = true;
+                }
+
+                std::lock_guard lock{console_mutex};
+                std::cout << "\u001b[36;1m---- " << dates[d] << (failed[d]? " (FAILED)" : "") << " ----\u001b[0m\n" << messages.str() << '\n';
+            }));
+        for(auto&& f : pending) f.get();
+    }
+
+    //Combined trend table: every project's click rates over all dates
+    std::ofstream trend_file{(fs::path{out_dir} / "trend.csv").string()};
+    trend_file << "Company,Project,Date,Morning,Afternoon,Evening\n";
+    for(std::size_t id = 0; id < shared.keys->size(); ++id)
+    {
+        auto&& [company, project] = shared.keys->key(id);
+        for(std::size_t d = 0; d < dates.size(); ++d)
+        {
+            trend_file << csv_field{company} << ',' << csv_field{project} << ',' << csv_field{dates[d]};
+            for(auto&& rate : trend[d][id]) trend_file << ',' << csv_field{rate};
+            trend_file.put('\n');
+        }
+    }
+    std::cout << "Wrote \u001b[35;1m" << dates.size() << "\u001b[0m dates and the trend table to \u001b[35;1m" << out_dir << "\u001b[0m\n";
+
+    if(std::find(std::begin(failed), std::end(failed), true) == std::end(failed)) return true;
+    std::cerr << "\u001b[31;1mERROR:\u001b[0m failed dates (missing rates in the trend table):";
+    for(std::size_t d = 0; d < dates.size(); ++d) if(failed[d]) std::cerr << ' ' << dates[d];
+    std::cerr << '\n';
+    return false;
+}
+
+bool DailyQA::run()
 {
     while(true)
     {
@@ -67,33 +444,13 @@ void DailyQA::run()
 
         switch(in)
         {
-            case 1:
-                std::cout << "Formatting Morning QA sheet...\n\n";
-                for(auto&& line : morning_sheet) morning_entries.insert({line[0]+line[1], line});
-                morning_QA();
-                std::cout << "\n\u001b[32;1mMorning QA Sheet successfully formatted.\u001b[0m\n ";
-
-                std::cout << "Formatting Throughput sheet...\n";
-                throughput();
-                std::cout << "\u001b[32;1mDone.\u001b[0m\n\n";
-                return;
-            case 2:
-                for(auto&& line : afternoon_sheet) afternoon_entries.insert({line[0]+line[1], line});
-                std::cout << " Afternoon QA report:  \n";
-                other_QA<1>();
-                std::cout << "\n\u001b[32;1mAfternoon QA Sheet successfully formatted.\u001b[0m\n ";
-
-                return;
-            case 3:
-                for(auto&& line : evening_sheet) evening_entries.insert({line[0]+line[1], line});
-                std::cout << " Evening QA report:  \n";
-                other_QA<0>();
-                std::cout << "\n\u001b[32;1mEvening QA Sheet successfully formatted.\u001b[0m\n ";
-                return;
+            case 1: return run(Stage::Morning);
+            case 2: return run(Stage::Afternoon);
+            case 3: return run(Stage::Evening);
             case 4:
                 ret = system("firefox https://saikishore-gowrishankar.github.io/DailyQA");
                 if(WIFSIGNALED(ret) && (WTERMSIG(ret) == SIGINT || WTERMSIG(ret) == SIGQUIT))
-                    return;
+                    return true;
                 std::cin.clear();
                 std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
                 [[fallthrough]];
@@ -101,11 +458,14 @@ void DailyQA::run()
             default:
                 //If debugging is necessary, add debug lines here, then #define DEBUG above
                 #ifdef DEBUG
-                    for(auto&& [first, second] : threshold_entries) std::cout << first << "---->" << second << '\n';
-                    std::cout << threshold_sheet << std::endl;
-                    for(auto&& line : threshold_sheet) std::cout << line.size() << ' ';
+                    if(!load({Names, Thresholds})) return false;
+                    for(std::size_t id = 0; id < threshold_entries.size(); ++id)
+                        if(threshold_entries.state[id] != NoThreshold)
+                            std::cout << keys->key(id).second << "---->" << threshold_entries.one_day[id] << ',' << threshold_entries.two_day[id] << '\n';
+                    std::cout << sheet(Thresholds) << std::endl;
+                    for(auto&& line : sheet(Thresholds)) std::cout << line.size() << ' ';
                     std::cout.put('\n');
-                    return;
+                    return true;
                 #else
                     std::cerr << "\u001b[31;1mERROR:\u001b[37;1m invalid selection\n";
                     continue;
@@ -114,13 +474,13 @@ void DailyQA::run()
     }
 }
 /*
-    TODO: Make thresholds() have high exception safety around calls to std::stod()
     TODO: Reduce/eliminate morning QA/threshold dependencies
 */
 void DailyQA::thresholds()
 {
-    std::string cached_company_name;
-    for(auto&& line : threshold_sheet)
+    threshold_entries.assign(keys->size(), NoThreshold);
+    cell cached_company_name;
+    for(auto&& line : sheet(Thresholds))
     {
         auto company = line[0], project = line[1],
                        _1threshold = line[3], _2threshold = line[2];
@@ -132,257 +492,321 @@ void DailyQA::thresholds()
         else if(company == "" && project != "") company = line[0] = cached_company_name;
         else if(company == "" && project == "_") { continue; }
 
-        //Remove '%' character
-        _1threshold.pop_back(); _2threshold.pop_back();
-
-        //auto _1 = std::stod(_1threshold);
-        //auto _2 = std::stod(_2threshold);
-
-        //Lookup based on concatenation of company and project
-        auto str = company+project;
-
         if(company != "_" && project != "_")
         {
-            double _1{-1.0}, _2{-1.0};
-            try
+            //Parsed once here into fixed-point; the '%' is ignored like any trailing text
+            fixed _1{}, _2{};
+            bool ok = parse_percent(_1threshold, _1) && parse_percent(_2threshold, _2);
+            if(!ok)
             {
-                _1 = std::stod(_1threshold);
-                _2 = std::stod(_2threshold);
+                *errors << "\u001b[31;1mERROR:\u001b[37;1m    " <<
+                    company << "\u001b[0m - " << project << " failed to convert threshold to floating-point value.\n";
+                ++metrics.bad_thresholds;
             }
-            catch(std::invalid_argument const&)
+            //First entry for a project wins
+            if(auto id = keys->find(company, project); id != npos && threshold_entries.state[id] == NoThreshold)
             {
-                std::cerr << "\u001b[31;1mERROR:\u001b[37;1m    " <<
-                    company << "\u001b[0m - " << project << " failed to convert threshold to floating-point value.\n";
-                _1 = _2 = -1.0;
+                threshold_entries.one_day[id] = _1;
+                threshold_entries.two_day[id] = _2;
+                threshold_entries.state[id] = ok? 0 : Err;
             }
-            threshold_entries.insert({str, {_1, _2}});
         }
     }
 }
-void DailyQA::add_throughput_entries()
+void DailyQA::add_click_rates()
 {
-    for(auto&& line : throughput_sheet)
+    //1 and 2 day only click rates of every project on the morning data sheet, parsed once
+    morning_rates.assign(keys->size(), Err);
+    for(std::size_t id = 0; id < morning_entries.size(); ++id)
     {
-        auto str = line[1] + line[2]; //Lookup based on concatenation, as before
-        if(auto search = name_entries.find(str); search != std::end(name_entries))
-            throughput_entries.insert(str);
+        if(morning_entries[id] == npos) continue;
+        auto match = sheet(Data)[morning_entries[id]];
+        auto _1 = match[10], _2 = match[8];
+        if(parse_percent(_1 == ""? "n/a" : _1, morning_rates.one_day[id]) && parse_percent(_2 == ""? "n/a" : _2, morning_rates.two_day[id]))
+            morning_rates.state[id] = 0;
+        else
+        {
+            auto&& [company, project] = keys->key(id);
+            *errors << "\u001b[31;1mERROR:\u001b[37;1m    " <<
+                company << "\u001b[0m - " << project << " failed to convert click rate to floating-point value.\n";
+            ++metrics.bad_rates;
+        }
+    }
+}
+void DailyQA::add_entries(Spreadsheet& sheet, LineEntries& entries)
+{
+    //First line for a project wins
+    entries.assign(keys->size(), npos);
+    for(std::size_t row{}; auto&& line : sheet)
+    {
+        if(auto id = keys->find(line[0], line[1]); id != npos && entries[id] == npos) entries[id] = row;
+        ++row;
     }
 }
 
-void DailyQA::add_name_entries()
+void DailyQA::scan_throughput()
 {
-    std::string cached_company_name;
-    for(auto&& line : names_sheet)
+    if(throughput_stats) return; //Already scanned
+
+    auto& stats = throughput_stats.emplace();
+    throughput_entries.assign(keys->size(), false);
+
+    //Campaigns of kept lines, interned in order of appearance
+    std::unordered_map<cell, std::uint32_t> campaign_ids{};
+    std::vector<cell> campaigns{};
+    std::deque<std::string> unescaped_campaigns{}; //Copies of campaigns the file does not keep (see csv::mapped())
+
+    //Lines are streamed straight from the file. Missing cells read as "_", as if padded to throughput_cells.
+    auto& file = *throughput_csv;
+    std::vector<cell> line{};
+    auto at = [&line](std::size_t i){ return i < line.size()? line[i] : cell{"_"}; };
+    for(auto offset = file.tell(); file.read_record(line, true); offset = file.tell())
     {
-        auto company = line[0], project = line[1];
+        ++stats.lines;
 
-        // The projects don't all have a company name listed next to them
-        // For example, if the company has multiple carriers it only lists the
-        // name next to the first project. This caches that name so that all
-        // projects under the same company have a company name listed when 
-        // the data is entered into the output file.
-        if(company != "") cached_company_name = company;
-        else if(company == "" && project != "") company = line[0] = cached_company_name;
-        else if(company == "" && project == "_") { continue; }
+        //Delete unnecessary projects on throughput sheet
+        auto id = keys->find(at(1), at(2));
+        if(id == npos) continue;
+        throughput_entries[id] = true;
+        ++stats.total_entries;
+
+        std::array<bool, carrier_count> present{};
+        bool val{};
+        for(std::size_t c = 0; c < carrier_count; ++c)
+        {
+            auto dat = at(carrier_columns[c]);
+            if(dat == "" || dat == "_") continue;
+
+            present[c] = true;
+            ++stats.total[c];
+
+            if(cell code{}; carrier_code(dat, code))
+            {
+                auto& provider = find_provider(code);
+                if(provider.name == "") { ++stats.unknown_providers; provider.name = "UNKNOWN"; }
+                ++provider.count;
+            }
+            //A line is kept if any carrier cell has no "N/A" anywhere in it (cells like "(8) N/A" or
+            //"(8) 1234 (N/A %)" are dropped too)
+            if(dat.find("N/A") == cell::npos) val = true;
+        }
+
+        auto n = std::count(std::begin(present), std::end(present), true);
+
+        //Update exclusive blocks
+        if(n == 1) ++stats.only[std::find(std::begin(present), std::end(present), true) - std::begin(present)];
 
-        // The lookup uses the concatenation of the company and the project names
-        // Then, insert into name_entries hash table for later usage in setting up throughput sheet.
-        auto str = company+project;
-        if(company != "_" && project != "_") name_entries.insert({str, line});
+        //Update blocks on all carriers
+        if(n == carrier_count) ++stats.all;
+
+        //Add to list of projects that will be in final throughput sheet (campaign ID for now, ranked below)
+        if(val)
+        {
+            auto campaign = at(3);
+            if(!file.mapped(campaign) && !campaign_ids.count(campaign)) campaign = unescaped_campaigns.emplace_back(campaign);
+            auto [it, inserted] = campaign_ids.try_emplace(campaign, static_cast<std::uint32_t>(campaigns.size()));
+            if(inserted) campaigns.push_back(campaign);
+            throughput_rows.push_back({std::uint64_t{keys->rank(id)} << 32 | it->second, offset});
+        }
     }
+
+    //Lines in throughput sheet are lexicographically sorted by company, then project, then campaign.
+    //Campaign IDs are replaced by their rank so that every comparison is on integers.
+    std::vector<std::uint32_t> order(campaigns.size()), rank(campaigns.size());
+    std::iota(std::begin(order), std::end(order), 0u);
+    std::sort(std::begin(order), std::end(order), [&](auto a, auto b){ return campaigns[a] < campaigns[b]; });
+    for(std::uint32_t i = 0; i < order.size(); ++i) rank[order[i]] = i;
+    for(auto&& row : throughput_rows) row.key = (row.key & ~0xffffffffULL) | rank[row.key & 0xffffffffULL];
+
+    //std::sort by campaign first: it makes the same comparisons as sorting the lines themselves, so lines
+    //with equal keys come out in the same order as always. One stable sort by company and project follows.
+    std::       sort(std::begin(throughput_rows), std::end(throughput_rows),
+                     [](auto&& a, auto&& b){ return (a.key & 0xffffffffULL) < (b.key & 0xffffffffULL); });
+    std::stable_sort(std::begin(throughput_rows), std::end(throughput_rows),
+                     [](auto&& a, auto&& b){ return (a.key >> 32) < (b.key >> 32); });
 }
 
 template<bool b>
 void DailyQA::other_QA()
 {
     LineEntries* entries = nullptr;
+    Spreadsheet* data = nullptr;
 
-    if constexpr (b) entries = &afternoon_entries;
-    else 	     entries = &evening_entries;
+    if constexpr (b) { entries = &afternoon_entries; data = &sheet(Afternoon); }
+    else 	     { entries = &evening_entries;   data = &sheet(Evening);   }
 
-    add_name_entries();
-    for(auto&& line : names_sheet)
+    //The sheet is formatted into one buffer and written at once
+    std::string buffer{};
+    buffer.reserve(sheet(Names).size() * 96);
+
+    for(std::size_t row{}; auto&& line : sheet(Names))
     {
         auto company = line[0], project = line[1];
-        auto str = company+project;
-        if(auto search = entries->find(str); search != std::end(*entries))
+        if(auto id = keys->row_id(row++); id != npos && (*entries)[id] != npos)
         {
-            auto& match = search->second;
+            ++metrics.hits;
+            auto match = (*data)[(*entries)[id]];
 
+            //Current, 1 day and 1 week click rates
             #define out(x,y) ( (x)[y] == ""? "n/a" : (x)[y]  )
-            auto const& cr       = out(match, 2);
-            auto const& cr_1day  = out(match, 4);
-            auto const& cr_1week = out(match, 6);
-
-            outfile << company << ',' << project << ','
-                    << cr << ',' << cr_1day << ',' << cr_1week << '\n';
+            append_field(buffer, company);
+            buffer += ',';
+            append_field(buffer, project);
+            for(auto column : {2, 4, 6}) { buffer += ','; append_field(buffer, out(match, column)); }
+            buffer += '\n';
             #undef out
         }
         else if(project == "_" || company == "_" || project == "" || company == "")
         {
-            outfile.put('\n');
+            ++metrics.separators;
+            buffer += '\n';
         }
         else
         {
-            outfile << company << ',' << project << ",\n";
+            ++metrics.misses;
+            append_field(buffer, company);
+            buffer += ',';
+            append_field(buffer, project);
+            buffer += ",\n";
         }
     }
+    outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 }
 void DailyQA::morning_QA()
 {
-    thresholds();
-    add_name_entries();
-    add_throughput_entries();
-    std::string cached_company_name;
-    for(auto&& line : names_sheet)
+    scan_throughput();
+
+    //Threshold check of every project in one batch
+    std::vector<std::uint8_t> verdicts(keys->size());
+    check_thresholds(verdicts.size(), threshold_entries.one_day.data(), threshold_entries.two_day.data(), threshold_entries.state.data(),
+                     morning_rates.one_day.data(), morning_rates.two_day.data(), morning_rates.state.data(), verdicts.data());
+
+    //The sheet is formatted into one buffer and written at once
+    std::string buffer{};
+    buffer.reserve(sheet(Names).size() * 128);
+
+    int ws_count = 0; //Whitespace count (merely for logging purposes)
+    for(std::size_t row{}; auto&& line : sheet(Names))
     {
         auto company = line[0], project = line[1];
-        auto str = company+project;
+        auto id = keys->row_id(row++);
 
-        static int ws_count = 0; //Whitespace count (merely for logging purposes)
-        if(auto search = morning_entries.find(str); search != std::end(morning_entries))
+        if(id != npos && morning_entries[id] != npos)
         {
+            ++metrics.hits;
+            auto match = sheet(Data)[morning_entries[id]];
             #define out(x,y) ( (x)[y] == ""? "n/a" : (x)[y]  )
-            auto const& _7 = out(search->second,4);
-            auto const& _3 = out(search->second,6);
-            auto const& _2 = out(search->second,8);
-            auto const& _1 = out(search->second,10);
-
-            auto t_1 = find_threshold(_1);
-            auto t_2 = find_threshold(_2);
+            append_field(buffer, company);
+            buffer += ',';
+            append_field(buffer, project);
+            for(auto column : {4, 6, 8, 10}) { buffer += ','; append_field(buffer, out(match, column)); }
+            #undef out
 
-            outfile << company << ',' << project << ','
-                    << _7 << ',' << _3 << ','<< _2 << ',' << _1;
-            if(auto s = threshold_entries.find(str); s != std::end(threshold_entries))
+            switch(verdicts[id])
             {
-                auto const& match = s->second;
-                if(throughput_entries.find(str) != std::end(throughput_entries))
-                    outfile << ",***,";
-                else
-                    outfile << ",n/a,";
-
-                if(match.first == -1.0) outfile << "ERR,ERR,ERR,ERR\n";
-                else outfile << ((match.first > t_1 && match.second > t_2)?"***,,***,\n":"no,n/a,no,n/a\n");
+                case NoThreshold:
+                    ++metrics.missing_thresholds;
+                    *errors << "\u001b[31;1mERROR:\u001b[37;1m    " << company << "\u001b[0m - " << project
+                        << " does not have a corresponding threshold entry\n";
+                    buffer += ",,ERR,ERR,ERR,ERR\n";
+                    break;
+                default:
+                    buffer += throughput_entries[id]? ",***," : ",n/a,";
+                    buffer += verdicts[id] == Err?  "ERR,ERR,ERR,ERR\n" :
+                              verdicts[id] == Pass? "***,,***,\n"       : "no,n/a,no,n/a\n";
             }
-            else
-            {
-                std::cerr << "\u001b[31;1mERROR:\u001b[37;1m    " << company << "\u001b[0m - " << project
-                    << " does not have a corresponding threshold entry\n";
-                outfile << ",,ERR,ERR,ERR,ERR\n";
-            }
-            #undef out
         }
         else if(project == "_" || company == "_" || project == "" || company == "")
         {
-            std::cout << "Skipping ws (" << ++ws_count << ")\r";
-            outfile << '\n';
+            ++metrics.separators;
+            *console << "Skipping ws (" << ++ws_count << ")\r";
+            buffer += '\n';
         }
         else
         {
             ws_count = 0;
-            std::cerr << "\u001b[31;1mERROR: Could not find:\u001b[37;1m    " << company << "\u001b[0m - " << project << "    \n";
-            outfile << company << ',' << project << ',' << "ERR,ERR,ERR,ERR,ERR,ERR,ERR,ERR,ERR\n";
+            ++metrics.misses;
+            *errors << "\u001b[31;1mERROR: Could not find:\u001b[37;1m    " << company << "\u001b[0m - " << project << "    \n";
+            append_field(buffer, company);
+            buffer += ',';
+            append_field(buffer, project);
+            buffer += ",ERR,ERR,ERR,ERR,ERR,ERR,ERR,ERR,ERR\n";
         }
     }
+    outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 }
 void DailyQA::throughput()
 {
-    //Counters
-    int total_ATT{}, total_verizon{}, total_sprint{}, total_tmobile{}, total_entries{};
-    int only_ATT{}, only_verizon{}, only_sprint{}, only_tmobile{};
-    int all{};
-
-    std::vector<Line> D2S{};
-
-    std::regex r{R"~(\(([0-9]+)\).+)~"}; //Regular expression to extract provider number
-    int unknown_providers{};
+    scan_throughput();
 
     //Column titles
     t_outfile << ",Company,Project,Campaign,Drip Name,Drip ID, ATT, Sprint,T-Mobile,Verizon,Tested,Edited\n";
 
-    //Delete unnecessary projects on throughput sheet
-    for(auto&& line : throughput_sheet)
+    //Output only D2S projects that are on the names sheet, re-reading each kept line from the file
+    auto& file = *throughput_csv;
+    file.advise(MADV_NORMAL); //Sorted order jumps around the file, sequential read-ahead would drop pages still needed
+    std::vector<cell> line{};
+    std::string buffer{};
+    buffer.reserve(throughput_rows.size() * 160);
+    for(auto&& row : throughput_rows)
     {
-        bool ATT{}, verizon{}, sprint{}, tmobile{}, val{};
-        auto str = line[1] + line[2]; //Lookup based on concatenation, as before
-        if(auto search = name_entries.find(str); search != std::end(name_entries))
+        file.seek(row.offset);
+        file.read_record(line, true);
+        for(std::size_t i = 0; i < throughput_cells; ++i)
         {
-            ++total_entries;
-
-            #define provider_block()\
-            {\
-                if(std::smatch m; std::regex_match(dat, m, r))\
-                {\
-                    if(auto search = provider_entries.find(m[1]); search != std::end(provider_entries)) ++search->second.second;\
-                    else { ++unknown_providers; provider_entries.insert({m[1],{"UNKNOWN",1}}); }\
-                }\
-            }
+            auto val = i < line.size()? line[i] : cell{"_"};
+            append_field(buffer, val=="_"?" ":val);
+            buffer += i + 1 < throughput_cells?',':'\n';
+        }
+    }
+    t_outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 
-            if(auto dat = line[6]; dat != "" && dat != "_"){ ATT     = ++total_ATT;  provider_block();    if(dat.find("N/A") == std::string::npos) val = true;}
-            if(auto dat = line[7]; dat != "" && dat != "_"){ sprint  = ++total_sprint;  provider_block(); if(dat.find("N/A") == std::string::npos) val = true;}
-            if(auto dat = line[8]; dat != "" && dat != "_"){ tmobile = ++total_tmobile; provider_block(); if(dat.find("N/A") == std::string::npos) val = true;}
-            if(auto dat = line[9]; dat != "" && dat != "_"){ verizon = ++total_verizon; provider_block(); if(dat.find("N/A") == std::string::npos) val = true;}
+    //Output stats (to file and stdout)
+    *console << "\u001b[32;1mThroughput sheet successfully formatted.\u001b[0m\n Outputting statistics to stdout...\n\n";
 
-            #undef provider_block
+    if(!log) *errors << "\u001b[31;1mError: could not open \u001b[35;1m" << files.log << "\u001b[0m\n";
+    print_stats(*console, true);
+    if(log)
+    {
+        *console << "\n\u001b[32;1mDone.\n\u001b[0m\nOutputting stats to \u001b[35;1m" << files.log << "\u001b[0m...";
+        print_stats(log, false);
+    }
 
-            //Update exclusive blocks
-            if(ATT && !sprint && !tmobile && !verizon) ++only_ATT;
-            if(!ATT && sprint && !tmobile && !verizon) ++only_sprint;
-            if(!ATT && !sprint && tmobile && !verizon) ++only_tmobile;
-            if(!ATT && !sprint && !tmobile && verizon) ++only_verizon;
+    if(auto unknown = throughput_stats->unknown_providers; unknown > 0)
+        *errors << "\n\u001b[31;1m" << "There are " << unknown << " unknown providers. Please update \u001b[35;1m" << files.sheets[Providers] << "\u001b[0m" << '\n';
+    console->put('\n');
+}
 
-            //Update blocks on all carriers
-            if(ATT && sprint && tmobile && verizon) ++all;
+void DailyQA::print_stats(std::ostream& out, bool colored) const
+{
+    auto const& stats = *throughput_stats;
 
-            //Add to list of projects that will be in final throughput sheet
-            if(val) D2S.push_back(line);
-        }
-    }
+    //Label is highlighted on the console, followed by a comma in the log
+    auto label = [&](auto const&... text) -> std::ostream&
+    {
+        if(colored) out << "\u001b[37;1m";
+        (out << ... << text);
+        return out << (colored? "\u001b[0m" : ",");
+    };
 
-    //Lines in throughput sheet are lexicographically sorted. 
-    //Stable sort is used to preserve relative order of elements, but is slightly less efficient
-    std::       sort(std::begin(D2S), std::end(D2S), [](auto&& a, auto&& b){ return a[3] < b[3]; }); //First sort by campaign name
-    std::stable_sort(std::begin(D2S), std::end(D2S), [](auto&& a, auto&& b){ return a[2] < b[2]; }); //Then sort by project name
-    std::stable_sort(std::begin(D2S), std::end(D2S), [](auto&& a, auto&& b){ return a[1] < b[1]; }); //Finally sort by company name
+    label("Number of entries before formatting: ") << stats.lines << "\n";
+    label("Total number of entries deleted: ") << stats.lines - stats.total_entries << "\n";
+    label("Final size of throughput sheet (entries): ") << stats.total_entries << "\n\n";
 
-    //Output only D2S projects that are on the names sheet.
-    for(auto&& line : D2S)
-       for(int i = 0; i < 10; ++i) { auto val = line[i]; t_outfile << (val=="_"?" ":val) << (i < 9?',':'\n'); }
+    label("Total ATT Blocks: ") << stats.total[ATT] << '\n';
+    label("Total Verizon Blocks: ") << stats.total[Verizon] << '\n';
+    label("Total Sprint Blocks: ") << stats.total[Sprint] << '\n';
+    label("Total T-Mobile Blocks: ") << stats.total[TMobile] << "\n\n";
 
-    //Output stats (to file and stdout)
-    std::cout << "\u001b[32;1mThroughput sheet successfully formatted.\u001b[0m\n Outputting statistics to stdout...\n\n";
-
-    auto tp_sz = throughput_sheet.size();
-    std::ostream* out = &std::cout;
-    bool outflag = false;
-    if(!log) std::cerr << "\u001b[31;1mError: could not open \u001b[35;1moutput/log.csv\u001b[0m\n";
-DUMP:
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Number of entries before formatting: " << (!outflag?"\u001b[0m":",") << tp_sz << "\n";
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Total number of entries deleted: " << (!outflag?"\u001b[0m":",") << tp_sz - total_entries << "\n";
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Final size of throughput sheet (entries): " << (!outflag?"\u001b[0m":",") << total_entries << "\n\n";
-
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Total ATT Blocks: " << (!outflag?"\u001b[0m":",") << total_ATT << '\n';
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Total Verizon Blocks: " << (!outflag?"\u001b[0m":",") << total_verizon << '\n';
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Total Sprint Blocks: " << (!outflag?"\u001b[0m":",") << total_sprint << '\n';
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Total T-Mobile Blocks: " << (!outflag?"\u001b[0m":",") << total_tmobile << "\n\n";
-
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Exclusive ATT Blocks: " << (!outflag?"\u001b[0m":",") << only_ATT << '\n';
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Exclusive Verizon Blocks: " << (!outflag?"\u001b[0m":",") << only_verizon << '\n';
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Exclusive Sprint Blocks: " << (!outflag?"\u001b[0m":",") << only_sprint << '\n';
-    (*out) << (!outflag?"\u001b[37;1m":"") << "Exclusive T-Mobile Blocks: " << (!outflag?"\u001b[0m":",") << only_tmobile << "\n\n";
-
-    (*out) << (!outflag?"\u001b[37;1m":"") << "All carrier Blocks: " << (!outflag?"\u001b[0m":",") << all << "\n\n";
-
-    for(auto&& [code, provider] : provider_entries)
-        (*out) << (!outflag?"\u001b[37;1m":"") << "Total " << provider.first << " (" << code << ") blocks:" << (!outflag?"\u001b[0m ":",") << provider.second << '\n';
-    if(!outflag && log)
-    {
-        outflag = true;
-        out = &log;
-        std::cout << "\n\u001b[32;1mDone.\n\u001b[0m\nOutputting stats to \u001b[35;1moutput/log.csv\u001b[0m...";
-        goto DUMP;
-    }
+    label("Exclusive ATT Blocks: ") << stats.only[ATT] << '\n';
+    label("Exclusive Verizon Blocks: ") << stats.only[Verizon] << '\n';
+    label("Exclusive Sprint Blocks: ") << stats.only[Sprint] << '\n';
+    label("Exclusive T-Mobile Blocks: ") << stats.only[TMobile] << "\n\n";
 
-    if(unknown_providers > 0) std::cerr << "\n\u001b[31;1m" << "There are " << unknown_providers << " unknown providers. Please update \u001b[35;1minput/providers.csv\u001b[0m" << '\n';
-    std::cout.put('\n');
+    label("All carrier Blocks: ") << stats.all << "\n\n";
+
+    for_each_provider([&](auto const& code, ProviderEntry const& provider)
+    {
+        label("Total ", provider.name, " (", code, ") blocks:") << (colored? " " : "") << provider.count << '\n';
+    });
 }
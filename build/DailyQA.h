@@ -2,9 +2,19 @@
 #pragma once
 
 /* Local Dependencies */
-#include <unordered_set>
-#include <unordered_map>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "spreadsheet.h"
+#include "keyindex.h"
+#include "threadpool.h"
+#include "metrics.h"
 
 // Uncomment to enable debugging output in run()
 //#define DEBUG
@@ -16,6 +26,27 @@ can easily be copy/pasted into the daily QA sheet.
 class DailyQA
 {
 public:
+    //Stages that can be run (see run(Stage))
+    enum class Stage : std::size_t { Morning, Afternoon, Evening };
+    static constexpr std::size_t stage_count = 3;
+    static constexpr std::string_view stage_names[stage_count] = {"morning", "afternoon", "evening"};
+
+    //Input sheets
+    enum Sheet : std::size_t { Names, Data, Throughput, Providers, Thresholds, Evening, Afternoon, sheet_count };
+    static constexpr std::string_view sheet_names[sheet_count] = {"names", "data", "throughput", "providers",
+                                                                  "thresholds", "evening", "afternoon"};
+
+    //Input and output file names
+    struct Files
+    {
+        std::array<std::string, sheet_count> sheets{"input/names.csv", "input/data.csv", "input/throughput.csv", "input/providers.csv",
+                                                    "input/thresholds.csv", "input/evening_data.csv", "input/afternoon_data.csv"};
+        std::array<std::string, stage_count> output{"output/output.csv", "output/output.csv", "output/output.csv"}; //QA sheet, per stage
+        std::string throughput{"output/t_outfile.csv"}; //Throughput sheet
+        std::string log{"output/log.csv"};              //Throughput stats
+        std::string metrics{"output/metrics.jsonl"};    //One JSON record appended per stage run
+    };
+
     template<typename ... Args>
     static DailyQA& get_singleton(Args... args)
     {
@@ -26,27 +57,73 @@ public:
     /**
      * run()
      *
-     * @brief Runs the main program and outputs into respective files
+     * @brief Runs the interactive menu and outputs into respective files
+     * @return false if the selected stage could not load its sheets
+     */
+    bool run();
+
+    /**
+     * run()
+     *
+     * @brief Runs a single stage without prompting. Only the sheets the stage needs are loaded.
+     * The stage's metrics are appended to files.metrics.
+     * @return false if a sheet or an output file could not be opened (reported on errors, the metrics
+     * record has "ok":false)
+     */
+    bool run(Stage s);
+
+    /**
+     * backfill()
+     *
+     * @brief Runs the stages for many report dates in parallel
+     * @param files Input sheets. Only the names, thresholds and providers sheets are used; they
+     * are parsed once and shared by every date.
+     * @param dir Directory with one subdirectory per date, each holding that date's data.csv,
+     * throughput.csv, afternoon_data.csv and/or evening_data.csv
+     * @param out_dir Each date's files are written to out_dir/<date>/, and the click rates of
+     * every project over all dates to out_dir/trend.csv
+     * @param stages Stages to run (all stages whose sheets exist for a date if empty)
+     * @param threads Number of dates processed at once
+     * @return false if dir or a reference sheet could not be read, or if any date failed. A failed
+     * date is reported with its messages and does not stop the other dates.
      */
-    void run();
+    static bool backfill(Files const& files, std::string const& dir, std::string const& out_dir,
+                         std::vector<Stage> const& stages, unsigned threads);
+
+    DailyQA(DailyQA const&) = delete;
+    DailyQA& operator=(DailyQA const&) = delete;
 
 private:
+    friend struct Bench; //Benchmark harness (bench.cpp) times the stages one by one
+
+    //Number of cells each line of a sheet is padded to (-1: no padding, the throughput sheet is not a Spreadsheet)
+    static constexpr std::array<int, sheet_count> line_lengths{-1, -1, -1, -1, 4, 7, 7};
+
+    /**
+     * DailyQA()
+     *
+     * @param files Names of the input sheets and output files. Sheets are not
+     * opened until a stage needs them.
+     */
+    explicit DailyQA(Files files);
 
     /**
      * DailyQA()
      *
-     * @param names File name of sheet with projects/companies
-     * @param data File name of URL spinner daily report
-     * @param throughput File name of sheet with throughput entries
-     * @param providers File name of sheet with provider mapping
+     * @param files Names of the input sheets and output files
+     * @param shared Instance whose names, thresholds and providers sheets (and everything
+     * derived from them) are shared read-only instead of being parsed again
      */
-    DailyQA(std::string_view names,
-            std::string_view data,
-            std::string_view throughput,
-            std::string_view providers,
-            std::string_view thresholds,
-            std::string_view evening_data,
-            std::string_view afternoon_data);
+    DailyQA(Files files, DailyQA const& shared);
+
+    //Parses the given sheets that are not loaded yet (concurrently if there is a pool).
+    //Returns false, before parsing anything, if one of them cannot be opened.
+    bool load(std::initializer_list<Sheet> needed);
+    bool loaded(Sheet s) const { return s == Throughput? bool(throughput_csv) : bool(sheets[s]); }
+    Spreadsheet& sheet(Sheet s) { return *sheets[s]; }
+
+    using LineEntries = std::vector<std::size_t>;
+    using LineLookup  = std::vector<bool>;
 
     //Stages
     //TODO: Add Afternoon + Evening QA, + possible others
@@ -59,35 +136,140 @@ private:
     template<bool b>
     void other_QA();
 
-    //Adds entries to respective hash tables (increase modularity, reduce dependencies)
-    void add_throughput_entries();
-    void add_name_entries();
+    //Joins sheets against the key index (increase modularity, reduce dependencies)
+    void add_entries(Spreadsheet& sheet, LineEntries& entries);
+    void scan_throughput();
+    void add_provider_entries();
+    void add_click_rates();
     void thresholds();
 
-    //Sheets that are opened
-    Spreadsheet names_sheet, morning_sheet, throughput_sheet; // For the names and data and throughput
-    Spreadsheet providers_sheet;			      // Stores the mapping between provider name and number
-    Spreadsheet threshold_sheet;			      // Stores the threshholds for DailyQA setup
-    Spreadsheet evening_sheet;				      // Evening data sheet
-    Spreadsheet afternoon_sheet;
-
-    using LineEntries = std::unordered_map<std::string, Line>;
-    using LineLookup = std::unordered_set<std::string>;
-
-    template<typename T1, typename T2>
-    using LineMap = std::unordered_map<std::string, std::pair<T1, T2>>;
-
-    //Parsed data stored in hash tables for easy lookup
-    LineEntries morning_entries{};    // Stores morning data entries
-    LineEntries afternoon_entries{};  // Stores afternoon data entries
-    LineEntries evening_entries{};    // Stores evening data entries
-    LineEntries name_entries{};       // Stores name entries (for throughput sheet)
-    LineLookup throughput_entries{};       // Stores name entries (for throughput sheet)
-    LineMap<std::string, int> provider_entries{}; 	// Stores provider mappings
-    LineMap<double, double> threshold_entries{};     // Stores threshold entries (for throughput sheet)
-
-    //Output files (no need for it to be a Spreadsheet)
-    std::ofstream outfile{"output/output.csv"}; //Output file
-    std::ofstream t_outfile{"output/t_outfile.csv"}; //Throughput output file
-    std::ofstream log{"output/log.csv"}; //Log throughput stats
+    //Click rate of project id in the sheet of stage s ("" if there is no entry)
+    cell click_rate(Stage s, std::size_t id);
+
+    //Throughput stats, colored for the console or as "label,value" lines for the log
+    void print_stats(std::ostream& out, bool colored) const;
+
+    //Appends the metrics of stage s to files.metrics
+    void write_metrics(Stage s) const;
+
+    Files files;
+
+    //Sheets that are opened (indexed by Sheet, null until loaded)
+    std::array<std::shared_ptr<Spreadsheet>, sheet_count> sheets{};
+    std::unique_ptr<csv> throughput_csv{};                // The throughput sheet is streamed instead (see scan_throughput())
+
+    std::shared_ptr<KeyIndex const> keys{};               // (company, project) -> ID, built from the names sheet
+
+    static constexpr std::size_t npos = KeyIndex::npos;
+
+    //Carrier columns of the throughput sheet
+    enum carrier : std::size_t { ATT, Sprint, TMobile, Verizon, carrier_count };
+
+    //Counters gathered in the single pass over the throughput sheet
+    struct ThroughputStats
+    {
+        std::size_t lines{};                          // Lines on the sheet
+        int total_entries{};                          // Lines whose project is on the names sheet
+        std::array<int, carrier_count> total{};       // Blocks per carrier
+        std::array<int, carrier_count> only{};        // Blocks on that carrier only
+        int all{};                                    // Blocks on all carriers
+        int unknown_providers{};                      // Provider codes missing from the providers sheet
+    };
+
+    //Throughput line kept for the throughput output
+    struct ThroughputRow
+    {
+        std::uint64_t key{};    // Rank of (company, project) << 32 | rank of campaign
+        std::size_t offset{};   // Where the line starts in the throughput sheet
+    };
+
+    //Percentages in fixed-point: millionths of a percent ("10.055%" -> 10055000), at most 1000 percent.
+    //32 bits so that compares vectorize on baseline x86-64.
+    using fixed = std::int32_t;
+
+    //Outcome of the threshold check of a project (states that force a verdict have bit 1 set, see check_thresholds())
+    enum Verdict : std::uint8_t { Fail, Pass, Err, NoThreshold };
+
+    //1 day and 2 day percentages of every project, indexed by key ID
+    struct Rates
+    {
+        std::vector<fixed> one_day{};
+        std::vector<fixed> two_day{};
+        std::vector<std::uint8_t> state{}; // 0 if both are valid, otherwise the Verdict they force
+
+        void assign(std::size_t n, Verdict v) { one_day.assign(n, 0); two_day.assign(n, 0); state.assign(n, v); }
+        std::size_t size() const { return state.size(); }
+    };
+
+    //Provider name and number of blocks (empty name: unused code)
+    struct ProviderEntry
+    {
+        cell name{};
+        int count{};
+    };
+
+    //Parsed data joined into arrays indexed by key ID
+    LineEntries morning_entries{};    // Row of morning data entry (npos if none)
+    LineEntries afternoon_entries{};  // Row of afternoon data entry (npos if none)
+    LineEntries evening_entries{};    // Row of evening data entry (npos if none)
+    LineLookup throughput_entries{};  // Whether the project is on the throughput sheet
+    std::optional<ThroughputStats> throughput_stats{}; // Set once the throughput sheet is scanned
+    std::vector<ThroughputRow> throughput_rows{};      // Kept throughput lines, sorted by key
+    std::vector<ProviderEntry> provider_entries{}; 	// Stores provider mappings, indexed by provider code
+
+    //Digit strings ordered by their numeric value
+    struct CodeOrder
+    {
+        bool operator()(std::string const& a, std::string const& b) const { return a.size() != b.size()? a.size() < b.size() : a < b; }
+    };
+    std::map<std::string, ProviderEntry, CodeOrder> provider_overflow{}; // Provider codes too large for provider_entries or with leading zeros
+
+    //Entry of a provider code given as digits, added if it is new
+    ProviderEntry& find_provider(cell digits);
+
+    //Calls f(code, provider) for every provider in use: dense codes in ascending order, then the others shortest first
+    template<typename F>
+    void for_each_provider(F&& f) const
+    {
+        for(std::size_t code = 0; code < provider_entries.size(); ++code)
+            if(provider_entries[code].name != "") f(code, provider_entries[code]);
+        for(auto&& [code, provider] : provider_overflow) f(code, provider);
+    }
+    Rates threshold_entries{};        // Thresholds (NoThreshold if the project has none)
+    Rates morning_rates{};            // 1 and 2 day only click rates of the morning data sheet
+
+    //Instrumentation of the current stage run (reset by run(Stage))
+    struct Metrics
+    {
+        bool ok{true};                                   // Every sheet of the stage could be loaded
+        double seconds{};                                // Whole stage
+        std::array<double, sheet_count> parse_seconds{}; // Sheets parsed by this stage (throughput: mapped)
+        std::array<std::size_t, sheet_count> rows{};     // Lines of the sheets parsed by this stage
+        double keys_seconds{};                           // KeyIndex construction
+        double thresholds_seconds{};                     // thresholds()
+        double join_seconds{};                           // add_entries()
+        double qa_seconds{};                             // morning_QA() or other_QA()
+        double scan_seconds{};                           // scan_throughput()
+        double throughput_seconds{};                     // throughput() output and stats
+        std::size_t hits{};                              // Names sheet projects found on the data sheet
+        std::size_t misses{};                            // Projects missing from the data sheet ("Could not find")
+        std::size_t separators{};                        // Separator lines of the names sheet
+        std::size_t missing_thresholds{};                // Projects without a threshold entry
+        std::size_t bad_thresholds{};                    // Thresholds that failed to convert
+        std::size_t bad_rates{};                         // Click rates that failed to convert
+    };
+    Metrics metrics{};
+    Metrics shared_metrics{}; // Load counters of the shared instance, reported by the next stage run
+
+    //Output files (no need for it to be a Spreadsheet), opened by the stage that writes them
+    std::ofstream outfile{}; //Output file
+    std::ofstream t_outfile{}; //Throughput output file
+    std::ofstream log{}; //Log throughput stats
+
+    //Progress and error messages
+    std::ostream* console{&std::cout};
+    std::ostream* errors{&std::cerr};
+
+    //Parses sheets (declared last so workers are joined before anything else is destroyed)
+    std::unique_ptr<ThreadPool> pool{};
 };
\ No newline at end of file
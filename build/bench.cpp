@@ -0,0 +1,385 @@
+/****************************************
+ * bench.cpp
+ *
+ * @brief Generates synthetic reports and times
+ * the parser and every QA stage on them
+ *
+ ****************************************/
+
+/* Standard dependencies */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Platform-specific dependencies */
+#include <sys/resource.h>
+
+/* Local dependencies */
+#include "DailyQA.h"
+
+/*************************************************************************
+ * Allocation counters
+ *************************************************************************/
+//Every allocation of the process goes through these, including the ones made by DailyQA
+static std::atomic<std::uint64_t> allocations{0}, allocated_bytes{0};
+
+void* operator new(std::size_t n)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(n, std::memory_order_relaxed);
+    if(void* p = std::malloc(n? n : 1)) return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+/*************************************************************************
+ * Report generator
+ *************************************************************************/
+ /*!
+ * Writes a complete set of input sheets shaped like the real daily report:
+ * companies with several projects (the company name is only listed next to
+ * the first one on the names and thresholds sheets), separator lines,
+ * missing and "n/a" rates, bad thresholds, projects that are not on the
+ * names sheet and provider codes that are not on the providers sheet.
+ * Some company and project names contain commas and quotes, so they are
+ * written as quoted fields. The output only depends on the number of rows.
+ */
+class Generator
+{
+public:
+    explicit Generator(std::size_t rows) : rows{rows} {}
+
+    void write(std::filesystem::path const& dir)
+    {
+        std::filesystem::create_directories(dir);
+        auto open = [&](char const* name){ return std::ofstream{dir / name, std::ios::binary}; };
+
+        auto names = open("names.csv"), thresholds = open("thresholds.csv"), data = open("data.csv"),
+             afternoon = open("afternoon_data.csv"), evening = open("evening_data.csv");
+        data << "Company Name,Project Name,Project Link,Daily Leads Link,1 Through 7 Day Clicked Rate,1 Through 7 Day Opt Out Rate,"
+                "1 Through 3 Day Clicked Rate,1 Through 3 Day Opt Out Rate,2 Day Only Clicked Rate,2 Day Only Opt Out Rate,"
+                "1 Day Only Clicked Rate,1 Day Only Opt Out Rate,Period Start UTC,Period End UTC\n";
+        afternoon << "Company Name,Project Name,Click Rate @ 1:00 PM,Opt-out Rate,Yesterday's Click Rate @ 1:00 PM,"
+                     "Opt-out Rate Yesterday,Click Rate @ 1:00 PM 7 Days Ago,Opt-out Rate 7 Days Ago\n";
+        evening << "Company Name,Project Name,Click Rate @ 5:00 PM,Opt-out Rate,Yesterday's Click Rate @ 5:00 PM,"
+                   "Opt-out Rate Yesterday,Click Rate @ 5:00 PM 7 Days Ago,Opt-out Rate 7 Days Ago\n";
+
+        for(std::size_t p = 0; p < rows; ++p)
+        {
+            auto c = p / projects_per_company;
+            auto first = p % projects_per_company == 0;
+            auto company = company_name(c), project = project_name(p);
+
+            if(first && p) { names << "_, \n"; thresholds << "_, ,_\n"; }
+            names << csv_field{first? company : ""} << ',' << csv_field{project} << ',' << next() % 2 << '\n';
+
+            if(chance(97))
+            {
+                thresholds << csv_field{first? company : ""} << ',' << csv_field{project};
+                for(int i = 0; i < 2; ++i)
+                    if(chance(10)) thresholds << ",n/a";
+                    else if(chance(1)) thresholds << ",TBD%";
+                    else thresholds << ',' << rate(2) << '%';
+                thresholds << '\n';
+            }
+
+            if(chance(95))
+            {
+                auto id = uuid();
+                data << csv_field{company} << ',' << csv_field{project} << ",https://manage.drips.com/Project/Dash/" << id
+                     << ",https://manage.drips.com/Company/Portal/" << uuid() << "?project=" << id << "&reportName=dailyleads";
+                for(int i = 0; i < 8; ++i) data << ',' << (chance(10)? "" : rate(3) + '%');
+                data << ",11/16/2021,11/23/2021\n";
+            }
+            for(auto* sheet : {&afternoon, &evening})
+                if(chance(90))
+                {
+                    *sheet << csv_field{company} << ',' << csv_field{project};
+                    for(int i = 0; i < 6; ++i) *sheet << ',' << (chance(10)? "" : rate(2) + '%');
+                    *sheet << '\n';
+                }
+        }
+
+        //Projects that were dropped from the names sheet
+        for(std::size_t p = 0; p < rows / 50; ++p)
+            data << csv_field{"Inactive " + company_name(p)} << ',' << csv_field{project_name(p)} << ",,,,,,,,,,,11/16/2021,11/23/2021\n";
+
+        auto throughput = open("throughput.csv");
+        for(std::size_t line = 0; line < rows; ++line)
+        {
+            auto p = next() % rows;
+            auto company = chance(10)? "Inactive " + company_name(p) : company_name(p / projects_per_company);
+            throughput << line << ',' << csv_field{company} << ',' << csv_field{project_name(p)} << ",Campaign " << next() % 64
+                       << ',' << next() % 10 + 1 << "thDay" << next() % 12 + 1 << "00PM," << next() % 1000000;
+            bool any = false;
+            for(int carrier = 0; carrier < 4; ++carrier)
+            {
+                throughput.put(',');
+                if(!chance(carrier == 3 && !any? 100 : 40)) continue;
+                any = true;
+                throughput << '(' << next() % provider_codes + 1 << ") " << 2000000000 + next() % 8000000000
+                           << " (" << (chance(30)? "N/A" : rate(3)) << "%)";
+            }
+            throughput << ",_\n";
+        }
+
+        //Only part of the provider codes in use are listed
+        auto providers = open("providers.csv");
+        for(unsigned code = 1; code <= provider_codes * 4 / 5; ++code) providers << code << ",Provider " << code << '\n';
+    }
+
+private:
+    static constexpr std::size_t projects_per_company = 8;
+    static constexpr unsigned provider_codes = 60;
+
+    //splitmix64, so the reports are the same with every standard library
+    std::uint64_t next()
+    {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    bool chance(unsigned pct) { return next() % 100 < pct; }
+
+    //Rate in the format of the report (e.g. "10.055" with 3 decimals), without the '%'
+    std::string rate(int decimals)
+    {
+        auto scale = decimals == 3? 1000ULL : 100ULL;
+        auto value = next() % (30 * scale);
+        char buf[16];
+        std::snprintf(buf, sizeof buf, "%llu.%0*llu", value / scale, decimals, value % scale);
+        return buf;
+    }
+
+    std::string uuid()
+    {
+        char buf[40];
+        unsigned long long a = next(), b = next();
+        std::snprintf(buf, sizeof buf, "%08llX-%04llX-%04llX-%04llX-%012llX", a >> 32, a >> 16 & 0xffff, a & 0xffff,
+                      b >> 48, b & 0xffffffffffffULL);
+        return buf;
+    }
+
+    static std::string company_name(std::size_t c)
+    {
+        static constexpr std::string_view words[] = {"American", "Apollo", "Summit", "Pacific", "Liberty", "Northern", "Bright", "Harbor"},
+                                          kinds[]  = {"Health", "Insurance", "Home Shield", "Leads", "Energy", "Auto", "Finance", "Solar"},
+                                          suffix[] = {"", " Corp", ", Inc.", " LLC", ", LLC"};
+        return std::string{words[c % 8]} + ' ' + std::string{kinds[c / 8 % 8]} + ' ' + std::to_string(c) + std::string{suffix[c % 5]};
+    }
+
+    static std::string project_name(std::size_t p)
+    {
+        static constexpr std::string_view kinds[] = {"After Hours", "Patient Financial Services 30-60 Days (Drive to Site)",
+                                                     "Renewals, Phase 2", "Medicare Supplement", "AHS - Live - CNAME",
+                                                     "Spring \"Promo\"", "Health Insurance - MAIN", "Re-engaged"};
+        return std::string{kinds[p % 8]} + " #" + std::to_string(p);
+    }
+
+    std::size_t rows;
+    std::uint64_t state{0x5eed};
+};
+
+/*************************************************************************
+ * Bench
+ *************************************************************************/
+ /*!
+ * Times one phase of the program at a time on a generated report.
+ */
+struct Bench
+{
+    struct Result
+    {
+        std::string phase{};
+        double seconds{};
+        std::size_t rows{};             // Lines processed by the phase
+        std::uintmax_t bytes{};         // Size of the input sheets read by the phase
+        std::uint64_t allocations{};    // operator new calls made by the phase
+        std::uint64_t allocated_bytes{};
+        long peak_rss_kb{};             // High-water mark of the process so far
+    };
+
+    //Runs f, which returns the number of lines it processed
+    template<typename F>
+    static Result measure(std::string phase, std::uintmax_t bytes, F&& f)
+    {
+        auto a = allocations.load(), b = allocated_bytes.load();
+        auto start = std::chrono::steady_clock::now();
+        std::size_t rows = f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        rusage usage{};
+        ::getrusage(RUSAGE_SELF, &usage);
+        return {std::move(phase), elapsed.count(), rows, bytes, allocations.load() - a, allocated_bytes.load() - b, usage.ru_maxrss};
+    }
+
+    //Times every phase on the report in dir
+    static std::vector<Result> run(std::filesystem::path const& dir)
+    {
+        using Sheet = DailyQA::Sheet;
+        DailyQA::Files files{};
+        for(std::size_t s = 0; s < DailyQA::sheet_count; ++s)
+            files.sheets[s] = (dir / std::filesystem::path{files.sheets[s]}.filename()).string();
+        std::filesystem::create_directories(dir / "output");
+        for(auto&& o : files.output) o = (dir / "output" / "output.csv").string();
+        files.throughput = (dir / "output" / "t_outfile.csv").string();
+        files.log = (dir / "output" / "log.csv").string();
+
+        auto size = [&](std::initializer_list<Sheet> sheets)
+        {
+            std::uintmax_t bytes{};
+            for(auto s : sheets) bytes += std::filesystem::file_size(files.sheets[s]);
+            return bytes;
+        };
+        std::vector<Result> results{};
+
+        //Parser alone, one sheet at a time
+        auto parse = [](Sheet s){ return "parse:" + std::string{DailyQA::sheet_names[s]}; };
+        for(auto s : {Sheet::Names, Sheet::Data, Sheet::Thresholds, Sheet::Providers, Sheet::Afternoon, Sheet::Evening})
+        {
+            std::optional<Spreadsheet> sheet{};
+            results.push_back(measure(parse(s), size({s}), [&]
+            {
+                return sheet.emplace(files.sheets[s], DailyQA::line_lengths[s]).size();
+            }));
+        }
+        results.push_back(measure(parse(Sheet::Throughput), size({Sheet::Throughput}), [&]
+        {
+            csv file{files.sheets[Sheet::Throughput]};
+            std::vector<cell> fields{};
+            std::size_t lines{};
+            while(file.read_record(fields, true)) ++lines;
+            return lines;
+        }));
+
+        //Stages, in the order run() calls them. Messages are discarded, they would only time the terminal.
+        DailyQA doc{files};
+        std::ostream null{nullptr};
+        doc.console = doc.errors = &null;
+
+        auto morning = {Sheet::Names, Sheet::Data, Sheet::Thresholds, Sheet::Throughput, Sheet::Providers};
+        results.push_back(measure("load:morning", size(morning), [&]
+        {
+            doc.load(morning);
+            return doc.sheet(Sheet::Names).size() + doc.sheet(Sheet::Data).size() + doc.sheet(Sheet::Thresholds).size();
+        }));
+        results.push_back(measure("scan_throughput", size({Sheet::Throughput}), [&]
+        {
+            doc.scan_throughput();
+            return doc.throughput_stats->lines;
+        }));
+        results.push_back(measure("morning_QA", size({Sheet::Names, Sheet::Data}), [&]
+        {
+            doc.outfile.open(files.output[0]);
+            doc.add_entries(doc.sheet(Sheet::Data), doc.morning_entries);
+            doc.add_click_rates();
+            doc.morning_QA();
+            doc.outfile.close();
+            return doc.sheet(Sheet::Names).size();
+        }));
+        results.push_back(measure("throughput", size({Sheet::Throughput}), [&]
+        {
+            doc.t_outfile.open(files.throughput);
+            doc.log.open(files.log);
+            doc.throughput();
+            doc.t_outfile.close();
+            doc.log.close();
+            return doc.throughput_rows.size();
+        }));
+
+        doc.load({Sheet::Afternoon, Sheet::Evening});
+        results.push_back(measure("other_QA<true>", size({Sheet::Names, Sheet::Afternoon}), [&]
+        {
+            doc.outfile.open(files.output[1]);
+            doc.add_entries(doc.sheet(Sheet::Afternoon), doc.afternoon_entries);
+            doc.other_QA<true>();
+            doc.outfile.close();
+            return doc.sheet(Sheet::Names).size();
+        }));
+        results.push_back(measure("other_QA<false>", size({Sheet::Names, Sheet::Evening}), [&]
+        {
+            doc.outfile.open(files.output[2]);
+            doc.add_entries(doc.sheet(Sheet::Evening), doc.evening_entries);
+            doc.other_QA<false>();
+            doc.outfile.close();
+            return doc.sheet(Sheet::Names).size();
+        }));
+        return results;
+    }
+};
+
+static void usage(char const* argv0)
+{
+    std::cout << "Usage: " << argv0 << " [options]\n\n"
+              << "Generates reports of the given sizes and times the parser and every QA stage on them.\n"
+              << "Results are written to stdout, one record per size and phase.\n\n"
+              << "Options:\n"
+              << "  --rows N           Projects and throughput lines per report (repeatable, default: 10000,\n"
+              << "                     100000 and 1000000)\n"
+              << "  -d DIR             Directory for the generated reports and outputs (default: bench)\n"
+              << "  --csv              Write CSV instead of JSON lines\n"
+              << "  -h, --help         Show this message\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::size_t> sizes{};
+    std::filesystem::path dir{"bench"};
+    bool as_csv = false;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+        if(arg == "-h" || arg == "--help") { usage(argv[0]); return 0; }
+        else if((arg == "--rows" || arg == "-d") && i + 1 < argc)
+        {
+            if(arg == "-d") dir = argv[++i];
+            else sizes.push_back(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if(arg == "--csv") as_csv = true;
+        else
+        {
+            std::cerr << "\u001b[31;1mERROR:\u001b[0m Unrecognized argument " << arg << "\n\n";
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if(sizes.empty()) sizes = {10000, 100000, 1000000};
+
+    if(as_csv) std::cout << "rows,phase,seconds,lines,lines_per_sec,bytes,bytes_per_sec,allocations,allocated_bytes,peak_rss_kb\n";
+    for(auto rows : sizes)
+    {
+        auto report = dir / std::to_string(rows);
+        std::cerr << "Generating \u001b[35;1m" << report.string() << "\u001b[0m...\n";
+        Generator{rows}.write(report);
+
+        std::cerr << "Running...\n";
+        for(auto&& r : Bench::run(report))
+        {
+            auto per_sec = [&](double n){ return r.seconds > 0? n / r.seconds : 0.0; };
+            if(as_csv)
+                std::cout << rows << ',' << r.phase << ',' << r.seconds << ',' << r.rows << ',' << per_sec(r.rows) << ','
+                          << r.bytes << ',' << per_sec(r.bytes) << ',' << r.allocations << ',' << r.allocated_bytes << ','
+                          << r.peak_rss_kb << '\n';
+            else
+                std::cout << "{\"rows\":" << rows << ",\"phase\":\"" << r.phase << "\",\"seconds\":" << r.seconds
+                          << ",\"lines\":" << r.rows << ",\"lines_per_sec\":" << per_sec(r.rows)
+                          << ",\"bytes\":" << r.bytes << ",\"bytes_per_sec\":" << per_sec(r.bytes)
+                          << ",\"allocations\":" << r.allocations << ",\"allocated_bytes\":" << r.allocated_bytes
+                          << ",\"peak_rss_kb\":" << r.peak_rss_kb << "}\n";
+        }
+    }
+    return 0;
+}
@@ -1,55 +1,216 @@
 /****************************************
  * csv.h
  *
- * Performs preprocessing on any csv files
+ * Read-only, memory-mapped RFC 4180 reader
  *
  ****************************************/
 #pragma once
 
 /* Standard dependencies */
-#include <fstream>
 #include <string_view>
 #include <string>
-#include <iterator>
-#include <iostream>
-#include <regex>
-#include <algorithm>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <utility>
+
+/* Platform-specific dependencies */
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /*************************************************************************
  * csv
  *************************************************************************/
  /*!
- * A class that extends std::fstream to preprocess CSV files
- * as dictated by the RFC 4180 standard. This class performs preprocessing
- * on all CSV files by removing all double-quotes around fields and replacing
- * embedded comma characters with an underscore for easier processing.
+ * A read-only view of a CSV file as dictated by the RFC 4180 standard.
+ * The file is memory-mapped and tokenized in a single pass; every field is
+ * handed out as a std::string_view into the mapping, so the input is never
+ * copied or modified. Quoted fields may contain commas, line breaks and
+ * escaped ("") quotes. Only fields with escaped quotes need to be unescaped,
+ * and those copies are owned by the csv object. Streaming readers can have
+ * their storage reused by every record (see read_record()).
  */
-class csv : public std::fstream
+class csv
 {
 public:
     /**
-     * @param std::string_view Opens file s
+     * @param std::string_view Maps file s
      */
-    csv(std::string_view s) : std::fstream{s.data()}
+    csv(std::string_view s) : path_{s}
     {
-        //Regular expressions
-        std::regex symbol_with_comma{ R"~("([^"]+)(,)([^"]+)")~" };
-        std::regex quotes_symbol{ R"~(".")~" };
+        int fd = ::open(path_.c_str(), O_RDONLY);
+        if(fd < 0) return;
+
+        //Only regular files can be mapped (a directory opens, but has no contents)
+        if(struct stat st{}; ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            ok_ = true;
+            size_ = static_cast<std::size_t>(st.st_size);
+            if(size_ > 0)
+            {
+                void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(p == MAP_FAILED) { ok_ = false; size_ = 0; }
+                else
+                {
+                    ::madvise(p, size_, MADV_SEQUENTIAL);
+                    data_ = static_cast<char const*>(p);
+                }
+            }
+        }
+        ::close(fd);
+    }
 
-        //Read line into buffer
-        std::getline(*this, buf_, (char)EOF);
+    ~csv() { if(data_) ::munmap(const_cast<char*>(data_), size_); }
 
-        //Replace commas in symbols with underscore
-        buf_ = std::regex_replace(buf_, symbol_with_comma, "$1_$3");
+    //The mapping is owned, so csv is move-only
+    csv(csv const&) = delete;
+    csv& operator=(csv const&) = delete;
+    csv(csv&& o) noexcept
+        : path_{std::move(o.path_)}, data_{std::exchange(o.data_, nullptr)}, size_{std::exchange(o.size_, 0)},
+          pos_{o.pos_}, ok_{o.ok_}, unescaped_{std::move(o.unescaped_)}, unescaped_used_{o.unescaped_used_} {}
+    csv& operator=(csv&&) = delete;
 
-        //Erase all double quote characters (remove-erase idiom)
-        buf_.erase(std::remove(std::begin(buf_), std::end(buf_), '"'), std::end(buf_));
+    explicit operator bool() const { return ok_; }
 
-        //Write new contents.
-        close(); open(s.data(), std::fstream::out | std::fstream::in | std::fstream::trunc);
-        *this << buf_;
-        seekp(0); seekg(0);
+    /**
+     * read_record()
+     *
+     * @brief Tokenizes the next record
+     * @param fields Cleared, then filled with views of each field of the record
+     * @param reuse Reuse the unescaped copies of earlier records instead of keeping them, which
+     * invalidates their views. Only fields with escaped quotes are affected (see mapped()).
+     * @return false once the end of the file is reached
+     *
+     * A trailing empty field is dropped, matching the std::getline based
+     * splitting this class replaced (i.e. "a,b," yields two fields).
+     */
+    bool read_record(std::vector<std::string_view>& fields, bool reuse = false)
+    {
+        fields.clear();
+        if(reuse) unescaped_used_ = 0;
+        if(pos_ >= size_) return false;
+
+        char const* p = data_ + pos_;
+        char const* const end = data_ + size_;
+        while(true)
+        {
+            std::string_view field{};
+            bool quoted = p != end && *p == '"';
+            if(quoted) p = quoted_field(p, end, field);
+            else
+            {
+                char const* q = p;
+                while(q != end && *q != ',' && *q != '\n') ++q;
+                field = {p, static_cast<std::size_t>(q - p)};
+                if(!field.empty() && field.back() == '\r' && (q == end || *q == '\n')) field.remove_suffix(1);
+                p = q;
+            }
+
+            if(p == end || *p == '\n')
+            {
+                if(quoted || !field.empty()) fields.push_back(field);
+                pos_ = (p == end)? size_ : static_cast<std::size_t>(p - data_) + 1;
+                return true;
+            }
+            fields.push_back(field);
+            ++p; //Skip ','
+        }
     }
+
+    //Size of the mapped file in bytes
+    std::size_t size() const { return size_; }
+
+    //Offset of the next record, which can be passed to seek() to read it again later
+    std::size_t tell() const { return pos_; }
+    void seek(std::size_t pos) { pos_ = pos; }
+
+    //Tells the kernel how the mapping is read from now on (see madvise(2)). It is MADV_SEQUENTIAL after
+    //construction, readers that seek() around should switch to MADV_NORMAL or MADV_RANDOM.
+    void advise(int advice) const { if(data_) ::madvise(const_cast<char*>(data_), size_, advice); }
+
+    //Whether field is a view into the mapped file, and so stays valid as long as the csv object
+    bool mapped(std::string_view field) const
+    {
+        return !std::less<char const*>{}(field.data(), data_) && std::less<char const*>{}(field.data(), data_ + size_);
+    }
+
 private:
-    std::string buf_{};
-};
\ No newline at end of file
+    //Parses the quoted field starting at p, returns a pointer to the delimiter following it
+    char const* quoted_field(char const* p, char const* end, std::string_view& field)
+    {
+        char const* first = ++p;
+        bool escaped = false;
+        while(p != end)
+        {
+            if(*p == '"')
+            {
+                if(p + 1 != end && p[1] == '"') { escaped = true; p += 2; continue; }
+                break;
+            }
+            ++p;
+        }
+        field = {first, static_cast<std::size_t>(p - first)};
+
+        if(escaped)
+        {
+            //Strings are kept once allocated, so reused records do not allocate again
+            auto& s = unescaped_used_ < unescaped_.size()? unescaped_[unescaped_used_] : unescaped_.emplace_back();
+            ++unescaped_used_;
+            s.clear();
+            s.reserve(field.size());
+            for(std::size_t i = 0; i < field.size(); ++i)
+            {
+                s.push_back(field[i]);
+                if(field[i] == '"') ++i;
+            }
+            field = s;
+        }
+
+        //Anything between the closing quote and the next delimiter is ignored
+        if(p != end) ++p;
+        while(p != end && *p != ',' && *p != '\n') ++p;
+        return p;
+    }
+
+    std::string path_{};                  //File name
+    char const* data_{nullptr};           //Mapped file contents
+    std::size_t size_{0};                 //Size of mapping
+    std::size_t pos_{0};                  //Tokenizer position
+    bool ok_{false};                      //File was opened
+    std::deque<std::string> unescaped_{}; //Fields that had escaped quotes (stable addresses)
+    std::size_t unescaped_used_{0};       //Strings of unescaped_ in use (the rest are reused scratch)
+};
+
+/*************************************************************************
+ * csv_field
+ *************************************************************************/
+ /*!
+ * Wraps a cell for output. The cell is re-quoted per RFC 4180 if it
+ * contains a comma, double-quote or line break so that it round-trips.
+ */
+struct csv_field
+{
+    std::string_view value;
+
+    friend std::ostream& operator<<(std::ostream& os, csv_field f)
+    {
+        if(f.value.find_first_of(",\"\r\n") == std::string_view::npos) return os << f.value;
+
+        os.put('"');
+        for(char c : f.value) { if(c == '"') os.put('"'); os.put(c); }
+        return os.put('"');
+    }
+};
+
+//Appends a cell to an output buffer, quoted the same way as csv_field
+inline void append_field(std::string& out, std::string_view value)
+{
+    if(value.find_first_of(",\"\r\n") == std::string_view::npos) { out += value; return; }
+
+    out.push_back('"');
+    for(char c : value) { if(c == '"') out.push_back('"'); out.push_back(c); }
+    out.push_back('"');
+}
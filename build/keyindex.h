@@ -0,0 +1,110 @@
+/****************************************
+ * keyindex.h
+ *
+ * Interns (company, project) pairs from
+ * the names sheet into dense integer IDs
+ *
+ ****************************************/
+#pragma once
+
+/* Standard dependencies */
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* Local dependencies */
+#include "spreadsheet.h"
+
+/*************************************************************************
+ * KeyIndex
+ *************************************************************************/
+ /*!
+ * Dictionary of every (company, project) pair on the names sheet. Each
+ * distinct pair is given a dense ID in [0, size()), so the other sheets can
+ * be joined once into flat ID-indexed arrays instead of each stage hashing
+ * company+project strings on its own.
+ */
+class KeyIndex
+{
+public:
+    using Key = std::pair<cell, cell>;               //(company, project)
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * KeyIndex()
+     *
+     * @param names The names sheet. Company cells left blank are filled in place.
+     */
+    explicit KeyIndex(Spreadsheet& names)
+    {
+        cell cached_company_name;
+        row_ids.reserve(names.size());
+        for(auto&& line : names)
+        {
+            auto company = line[0], project = line[1];
+
+            // The projects don't all have a company name listed next to them
+            // For example, if the company has multiple carriers it only lists the
+            // name next to the first project. This caches that name so that all
+            // projects under the same company have a company name listed when
+            // the data is entered into the output file.
+            if(company != "") cached_company_name = company;
+            else if(company == "" && project != "") company = line[0] = cached_company_name;
+
+            // Separator rows ("_" or blank) don't get an ID
+            if(company == "_" || project == "_" || company == "" || project == "") row_ids.push_back(npos);
+            else row_ids.push_back(intern(company, project));
+        }
+
+        //Lexicographic (company, project) order of the IDs
+        std::vector<std::size_t> order(keys.size());
+        std::iota(std::begin(order), std::end(order), std::size_t{});
+        std::sort(std::begin(order), std::end(order), [this](auto a, auto b){ return keys[a] < keys[b]; });
+        ranks.resize(keys.size());
+        for(std::size_t i = 0; i < order.size(); ++i) ranks[order[i]] = i;
+    }
+
+    //ID of a (company, project) pair, or npos if it is not on the names sheet
+    std::size_t find(cell company, cell project) const
+    {
+        auto search = ids.find({company, project});
+        return search != std::end(ids)? search->second : npos;
+    }
+
+    //ID of the given line of the names sheet, or npos for separator lines
+    std::size_t row_id(std::size_t row) const { return row_ids[row]; }
+
+    Key const& key(std::size_t id) const { return keys[id]; }
+
+    //Position of an ID's key when all keys are sorted by company, then project
+    std::size_t rank(std::size_t id) const { return ranks[id]; }
+
+    //Number of distinct IDs
+    std::size_t size() const { return keys.size(); }
+
+private:
+    std::size_t intern(cell company, cell project)
+    {
+        auto [it, inserted] = ids.try_emplace({company, project}, keys.size());
+        if(inserted) keys.emplace_back(company, project);
+        return it->second;
+    }
+
+    struct KeyHash
+    {
+        std::size_t operator()(Key const& k) const noexcept
+        {
+            auto h = std::hash<cell>{}(k.first);
+            return h ^ (std::hash<cell>{}(k.second) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+        }
+    };
+
+    std::unordered_map<Key, std::size_t, KeyHash> ids{}; //Key -> ID
+    std::vector<Key> keys{};                             //ID -> Key
+    std::vector<std::size_t> row_ids{};                  //Names sheet line -> ID
+    std::vector<std::size_t> ranks{};                    //ID -> lexicographic rank
+};
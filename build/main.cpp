@@ -1,24 +1,109 @@
 //main.cpp
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include "DailyQA.h"
 
-int main()
+//Command line names of the input sheets (same order as DailyQA::Sheet) and their default file names
+static constexpr std::string_view sheet_options[DailyQA::sheet_count] = {"--names", "--data", "--throughput", "--providers",
+                                                                         "--thresholds", "--evening", "--afternoon"};
+static constexpr std::string_view sheet_files[DailyQA::sheet_count] = {"names.csv", "data.csv", "throughput.csv", "providers.csv",
+                                                                       "thresholds.csv", "evening_data.csv", "afternoon_data.csv"};
+static constexpr auto& stage_names = DailyQA::stage_names;
+
+static void usage(char const* argv0)
+{
+    std::cout << "Usage: " << argv0 << " [options] [stage...]\n\n"
+              << "Stages (run in the order given, without prompting):\n"
+              << "  morning            Morning QA sheet and throughput sheet\n"
+              << "  afternoon          Afternoon QA sheet\n"
+              << "  evening            Evening QA sheet\n"
+              << "With no stage, the interactive menu is shown (or every stage is run with --backfill).\n\n"
+              << "Options:\n"
+              << "  -i DIR             Directory holding the input sheets (default: input)\n"
+              << "  -o DIR             Directory for the output files (default: output). The QA sheet is\n"
+              << "                     written to DIR/<stage>.csv in batch mode, DIR/output.csv otherwise.\n"
+              << "                     Timings and counters of every stage run are appended to DIR/metrics.jsonl.\n"
+              << "  --backfill DIR     Run the stages for every dated subdirectory of DIR (each holding that date's\n"
+              << "                     data, throughput, afternoon and evening sheets), writing the output of each\n"
+              << "                     date to <output>/<date>/ and the click rate trends to <output>/trend.csv\n"
+              << "  -j N               Number of dates processed at once by --backfill (default: all cores)\n";
+    for(std::size_t s = 0; s < DailyQA::sheet_count; ++s)
+        std::cout << "  " << sheet_options[s] << " FILE" << std::string(14 - sheet_options[s].size(), ' ')
+                  << "Use FILE instead of DIR/" << sheet_files[s] << '\n';
+    std::cout << "  -h, --help         Show this message\n";
+}
+
+int main(int argc, char** argv)
 {
+    std::string input_dir{"input"}, output_dir{"output"}, backfill_dir{};
+    unsigned threads = std::thread::hardware_concurrency();
+    std::array<std::string, DailyQA::sheet_count> sheet_overrides{};
+    std::vector<DailyQA::Stage> stages{};
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+        auto value = [&]() -> char const*
+        {
+            if(i + 1 < argc) return argv[++i];
+            std::cerr << "\u001b[31;1mERROR:\u001b[0m " << arg << " needs an argument\n";
+            std::exit(1);
+        };
+
+        if(arg == "-h" || arg == "--help") { usage(argv[0]); return 0; }
+        else if(arg == "-i") input_dir = value();
+        else if(arg == "-o") output_dir = value();
+        else if(arg == "--backfill") backfill_dir = value();
+        else if(arg == "-j") threads = std::strtoul(value(), nullptr, 10);
+        else if(auto o = std::find(std::begin(sheet_options), std::end(sheet_options), arg); o != std::end(sheet_options))
+            sheet_overrides[o - std::begin(sheet_options)] = value();
+        else if(auto s = std::find(std::begin(stage_names), std::end(stage_names), arg); s != std::end(stage_names))
+        {
+            auto stage = static_cast<DailyQA::Stage>(s - std::begin(stage_names));
+            if(std::find(std::begin(stages), std::end(stages), stage) == std::end(stages)) stages.push_back(stage);
+        }
+        else
+        {
+            std::cerr << "\u001b[31;1mERROR:\u001b[0m Unrecognized argument " << arg << "\n\n";
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    DailyQA::Files files{};
+    for(std::size_t s = 0; s < DailyQA::sheet_count; ++s)
+        files.sheets[s] = !sheet_overrides[s].empty()? sheet_overrides[s] : input_dir + '/' + std::string{sheet_files[s]};
+    for(std::size_t s = 0; s < DailyQA::stage_count; ++s)
+        files.output[s] = output_dir + '/' + (stages.empty()? std::string{"output"} : std::string{stage_names[s]}) + ".csv";
+    files.throughput = output_dir + "/t_outfile.csv";
+    files.log = output_dir + "/log.csv";
+    files.metrics = output_dir + "/metrics.jsonl";
+
     std::cout << "\u001b[36;1m\n--------------------------------------------------------------------------\u001b[0m\n";
     std::cout << "|\u001b[33;1mDaily QA Sheet generator\u001b[0m\n";
     std::cout << "\u001b[36;1m--------------------------------------------------------------------------\u001b[0m\n";
 
-    std::cout << "opening \u001b[35;1minput/names.csv\u001b[0m, \u001b[35;1minput/data.csv\u001b[0m, and \u001b[35;1minput/throughput.csv\u001b[0m\n";
+    std::cout << "Reading input sheets from \u001b[35;1m" << input_dir << "\u001b[0m as needed\n";
 
-    DailyQA& doc = DailyQA::get_singleton("input/names.csv", "input/data.csv","input/throughput.csv", "input/providers.csv", "input/thresholds.csv",
-                                          "input/evening_data.csv", "input/afternoon_data.csv");
+    if(!backfill_dir.empty()) return DailyQA::backfill(files, backfill_dir, output_dir, stages, threads)? 0 : 1;
 
-    std::cout << "\u001b[32;1mSuccessfully opened aforementioned files.\u001b[0m\n\nRunning main program.\n";
+    DailyQA& doc = DailyQA::get_singleton(files);
 
-    doc.run();
+    if(stages.empty())
+    {
+        std::cout << "\nRunning main program.\n";
+        if(!doc.run()) { std::cerr << "Abort.\n"; return 1; }
+    }
+    else for(auto s : stages) if(!doc.run(s)) { std::cerr << "Abort.\n"; return 1; }
 
     std::cout << "\u001b[36;1m--------------------------------------------------------------------------\u001b[0m\n";
-    std::cout << "\nFinished. Find results in \u001b[35;1moutput/output.csv\u001b[0m and throughput results in \u001b[35;1moutput/t_output.csv\u001b[0m. Terminating.\n\n";
+    std::cout << "\nFinished. Find results in \u001b[35;1m" << output_dir << "\u001b[0m. Terminating.\n\n";
 
     return 0;
 }
@@ -0,0 +1,74 @@
+/****************************************
+ * metrics.h
+ *
+ * Helpers for the run metrics: a wall
+ * clock stopwatch and JSON output
+ *
+ ****************************************/
+#pragma once
+
+/* Standard dependencies */
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/*************************************************************************
+ * Stopwatch
+ *************************************************************************/
+ /*!
+ * Measures wall time from its construction. Reading it costs one clock call,
+ * so stages can be timed without noticeable overhead.
+ */
+class Stopwatch
+{
+public:
+    //Seconds elapsed since construction
+    double seconds() const { return std::chrono::duration<double>(clock::now() - start).count(); }
+
+private:
+    using clock = std::chrono::steady_clock;
+    clock::time_point start{clock::now()};
+};
+
+/*************************************************************************
+ * json_string
+ *************************************************************************/
+ /*!
+ * Wraps text for output as a quoted JSON string, escaping quotes,
+ * backslashes and control characters.
+ */
+struct json_string
+{
+    std::string_view value;
+
+    friend std::ostream& operator<<(std::ostream& os, json_string s)
+    {
+        os.put('"');
+        for(unsigned char c : s.value)
+        {
+            if(c == '"' || c == '\\') os.put('\\').put(static_cast<char>(c));
+            else if(c < 0x20)
+            {
+                char buf[8];
+                std::snprintf(buf, sizeof buf, "\\u%04x", c);
+                os << buf;
+            }
+            else os.put(static_cast<char>(c));
+        }
+        return os.put('"');
+    }
+};
+
+//Current UTC time in ISO 8601 (e.g. "2021-11-23T13:05:00Z")
+inline std::string utc_timestamp()
+{
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+    char buf[32];
+    std::strftime(buf, sizeof buf, "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return buf;
+}
@@ -13,7 +13,6 @@
 #pragma once
 
 /* Standard dependencies */
-#include <fstream>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -21,66 +20,72 @@
 #include <sstream>
 #include <algorithm>
 #include <cstdlib>
+#include <cstdint>
 #include <cmath>
 #include <iterator>
+#include <utility>
 
 /* Local dependencies */
 #include "csv.h"
 
-using cell = std::string;
+using cell = std::string_view; //Views into the mapped csv file
 class Spreadsheet;
 
 /******************************************************************************
  *  Line
  ******************************************************************************/
-/*! Represents the interface for a line in the spreadsheet*/
+/*! Represents the interface for a line in the spreadsheet. A Line is a
+ *  lightweight view of one row of its Spreadsheet's columns and is cheap to copy.*/
 
 class Line
 {
 public:
 
     /* Implementation details*/
-    using       iterator = std::vector<cell>::      iterator;
-    using const_iterator = std::vector<cell>::const_iterator;
+    template<typename Sheet, typename Ref>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = cell;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = std::remove_reference_t<Ref>*;
+        using reference         = Ref;
+
+        basic_iterator() = default;
+        basic_iterator(Sheet* s, std::size_t row, std::size_t col) : sheet{s}, row{row}, col{col} {}
+
+        reference       operator*() const;
+        basic_iterator& operator++()    { ++col; return *this; }
+        basic_iterator  operator++(int) { auto tmp = *this; ++col; return tmp; }
+        bool operator==(basic_iterator const& o) const { return col == o.col; }
+        bool operator!=(basic_iterator const& o) const { return col != o.col; }
+
+    private:
+        Sheet* sheet{nullptr};
+        std::size_t row{}, col{};
+    };
+    using       iterator = basic_iterator<Spreadsheet,       cell&>;
+    using const_iterator = basic_iterator<Spreadsheet const, cell const&>;
 
     /**
      * @brief Iterator methods for range-based for
      */
-    iterator       begin()  { return std::begin(cells);  }
-    iterator       end()    { return std::end(cells);    }
-    const_iterator cbegin() { return std::cbegin(cells); }
-    const_iterator cend()   { return std::cend(cells);   }
+    iterator       begin()  { return {sheet, row, 0};      }
+    iterator       end()    { return {sheet, row, size()}; }
+    const_iterator begin()  const { return {sheet, row, 0};      }
+    const_iterator end()    const { return {sheet, row, size()}; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend()   const { return end();   }
 
     /**
      * Line()
      *
-     * @brief Extracts cells from raw line
-     * @param raw Raw line data
-     * @param line_length Number of cells each line should be. If size is less than line_length,
-     * empty cells are created to extend the length.
+     * @brief Views a row of a spreadsheet
+     * @param s The spreadsheet that owns the cells
+     * @param row Index of the row
      */
-    Line(cell const& raw, int line_length)
-    {
-        using namespace std::string_literals;
-
-        std::istringstream ss{raw};
-        cell c;
-        auto str = ss.str();
-        if(str[0] == '"')
-        {
-            // @todo Fix output of names w/ comma
-            ss.get();
-            std::getline(ss, c, '"');
-
-            cells.push_back("\""s+c+"\""s);
-            ss.get();
-        }
-        while(std::getline(ss, c, ',')) cells.push_back(c);
-
-        auto sz = std::size(cells);
-        if(line_length > 0 && sz < (unsigned)line_length)
-            for(int i = sz; i < line_length; ++i) cells.push_back("_");
-    }
+    Line(Spreadsheet* s, std::size_t row) : sheet{s}, row{row} {}
 
     /**
      * to_raw()
@@ -88,10 +93,10 @@ public:
      * @brief Extracts cells from raw line
      * @return std::string holding raw data
      */
-    cell to_raw() const
+    std::string to_raw() const
     {
         std::ostringstream ss;
-        std::copy(std::begin(cells), std::end(cells), std::ostream_iterator<cell>(ss, ","));
+        std::copy(begin(), end(), std::ostream_iterator<cell>(ss, ","));
         auto val = ss.str();
         val.pop_back();
         return val;
@@ -104,60 +109,100 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& os, Line const& l)
     {
-        std::copy(std::begin(l.cells), std::end(l.cells), std::ostream_iterator<cell>(os, " "));
+        std::copy(l.begin(), l.end(), std::ostream_iterator<cell>(os, " "));
         return os;
     }
 
-    std::size_t size() const { return std::size(cells); }
+    std::size_t size() const;
 
     /**
      * operator[]()
      *
      * @brief Access individual cells
      */
-    cell&       operator[] (std::ptrdiff_t off)         { return cells[off]; }
-    cell const& operator[] (std::ptrdiff_t off) const   { return cells[off]; }
+    cell&       operator[] (std::ptrdiff_t off);
+    cell const& operator[] (std::ptrdiff_t off) const;
 
 
 private:
-    /* Parsed cells */
-    std::vector<cell> cells{};
+    /* Viewed row */
+    Spreadsheet* sheet;
+    std::size_t row;
 };
 
 /******************************************************************************
  *  Spreadsheet
  ******************************************************************************/
- /*! Defines the interface for a spreadsheet parser */
+ /*! Defines the interface for a spreadsheet parser. Cells are stored column by
+  *  column: each column is one contiguous array of views into the mapped file,
+  *  so loading a sheet costs a handful of allocations rather than several per row. */
 class Spreadsheet
 {
 public:
 
     /* Implementation details*/
     friend class Line;
-    using iterator       = std::vector<Line>::      iterator;
-    using const_iterator = std::vector<Line>::const_iterator;
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Line;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = Line;
+
+        iterator() = default;
+        iterator(Spreadsheet* s, std::size_t row) : sheet{s}, row{row} {}
+
+        Line      operator*() const { return {sheet, row}; }
+        iterator& operator++()    { ++row; return *this; }
+        iterator  operator++(int) { auto tmp = *this; ++row; return tmp; }
+        bool operator==(iterator const& o) const { return row == o.row; }
+        bool operator!=(iterator const& o) const { return row != o.row; }
+        std::size_t index() const { return row; }
+
+    private:
+        Spreadsheet* sheet{nullptr};
+        std::size_t row{};
+    };
+    using const_iterator = iterator;
 
     //Iterator methods for range-based for
-    iterator       begin()  { return std::begin(lines);  }
-    iterator       end()    { return std::end(lines);    }
-    const_iterator cbegin() { return std::cbegin(lines); }
-    const_iterator cend()   { return std::cend(lines);   }
+    iterator       begin()  { return {this, 0};      }
+    iterator       end()    { return {this, size()}; }
+    const_iterator cbegin() { return begin(); }
+    const_iterator cend()   { return end();   }
 
     /**
      * Spreadsheet()
      *
      * @param in The input file name
-     * @param line_length The length of each line in cells
+     * @param line_length The length of each line in cells. Shorter lines are padded with "_".
      **/
-    Spreadsheet(std::string_view in, int line_length = -1) : infile{in}
+    Spreadsheet(std::string_view in, int line_length = -1) : Spreadsheet{csv{in}, line_length}
     {
         if(!infile) { std::cerr << "could not open file " << in.data() << ". Abort.\n"; std::exit(1); }
+    }
 
-        std::string raw_line{};
-        infile.seekg(0); infile.seekp(0);
-        while(std::getline(infile, raw_line))
+    /**
+     * Spreadsheet()
+     *
+     * @param file An opened input file, so that callers can handle a missing file themselves
+     * @param line_length The length of each line in cells. Shorter lines are padded with "_".
+     **/
+    explicit Spreadsheet(csv file, int line_length = -1) : infile{std::move(file)}
+    {
+        std::size_t const pad = line_length > 0? line_length : 0;
+        std::vector<cell> fields{};
+        while(infile.read_record(fields))
         {
-            lines.emplace_back(raw_line, line_length);
+            auto const width = std::max(fields.size(), pad);
+            auto const row   = widths.size();
+            while(columns.size() < width) columns.emplace_back(row); //New column, earlier rows are empty
+
+            for(std::size_t i = 0; i < columns.size(); ++i)
+                columns[i].push_back(i < fields.size()? fields[i] : i < width? cell{"_"} : cell{});
+            widths.push_back(static_cast<std::uint32_t>(width));
         }
     }
 
@@ -167,27 +212,50 @@ public:
      * @brief Outputs formatted spreadsheet
      *
      **/
-    friend std::ostream& operator<<(std::ostream& os, Spreadsheet const& s)
+    friend std::ostream& operator<<(std::ostream& os, Spreadsheet& s)
     {
-        for(auto&& l : s.lines) os << l << '\n';
+        for(auto&& l : s) os << l << '\n';
         return os;
     }
 
-    auto erase(iterator pos) { return lines.erase(pos); }
-    auto erase(const_iterator pos) { return lines.erase(pos); }
-    auto erase(iterator first, iterator last ) { return lines.erase(first, last); }
-    auto erase(const_iterator first, const_iterator last ) { return lines.erase(first, last); }
+    iterator erase(iterator pos) { return erase(pos, std::next(pos)); }
+    iterator erase(iterator first, iterator last)
+    {
+        auto f = static_cast<std::ptrdiff_t>(first.index()), l = static_cast<std::ptrdiff_t>(last.index());
+        for(auto&& col : columns) col.erase(std::begin(col) + f, std::begin(col) + l);
+        widths.erase(std::begin(widths) + f, std::begin(widths) + l);
+        return {this, first.index()};
+    }
 
     template<typename UnaryPredicate>
     void remove_erase_if(UnaryPredicate p)
     {
-        auto new_end = std::remove_if(std::begin(lines), std::end(lines), p);
-        lines.erase(new_end, std::end(lines));
+        std::size_t kept = 0;
+        for(std::size_t row = 0; row < size(); ++row)
+        {
+            if(p(Line{this, row})) continue;
+            for(auto&& col : columns) col[kept] = col[row];
+            widths[kept++] = widths[row];
+        }
+        for(auto&& col : columns) col.resize(kept);
+        widths.resize(kept);
     }
 
-    std::size_t size() const { return lines.size(); }
+    std::size_t size() const { return widths.size(); }
+
+    //Access an individual line
+    Line operator[] (std::size_t row) { return {this, row}; }
 
 private:
-    csv infile;			//Input file
-    std::vector<Line> lines{};	//Parsed lines
+    csv infile;                             //Input file (owns the mapping the cells point into)
+    std::vector<std::vector<cell>> columns{}; //Parsed cells, one contiguous array per column
+    std::vector<std::uint32_t> widths{};    //Number of cells in each line
 };
+
+/* Line accessors (need the complete Spreadsheet) */
+template<typename Sheet, typename Ref>
+inline Ref Line::basic_iterator<Sheet, Ref>::operator*() const { return sheet->columns[col][row]; }
+
+inline std::size_t Line::size() const { return sheet->widths[row]; }
+inline cell&       Line::operator[] (std::ptrdiff_t off)       { return sheet->columns[off][row]; }
+inline cell const& Line::operator[] (std::ptrdiff_t off) const { return sheet->columns[off][row]; }
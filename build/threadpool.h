@@ -0,0 +1,134 @@
+/****************************************
+ * threadpool.h
+ *
+ * Fixed-size, work-stealing pool of
+ * worker threads
+ *
+ ****************************************/
+#pragma once
+
+/* Standard dependencies */
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*************************************************************************
+ * ThreadPool
+ *************************************************************************/
+ /*!
+ * Runs submitted tasks on a fixed set of worker threads. Every worker owns
+ * a deque of tasks: it takes its newest task first and, once its own deque
+ * is empty, steals the oldest task of another worker, so uneven workloads
+ * (e.g. report dates of very different sizes) stay balanced. Tasks submitted
+ * from a worker go to that worker's deque, others are spread round-robin.
+ * Workers are joined when the pool is destroyed, after the queued tasks have run.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @param threads Number of workers (defaults to the number of hardware threads)
+     */
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency())
+    {
+        threads = std::max(threads, 1u);
+        queues.reserve(threads);
+        for(unsigned i = 0; i < threads; ++i) queues.push_back(std::make_unique<Queue>());
+        workers.reserve(threads);
+        for(unsigned i = 0; i < threads; ++i) workers.emplace_back([this, i]{ work(i); });
+    }
+
+    ~ThreadPool()
+    {
+        { std::lock_guard lock{m}; stop = true; }
+        cv.notify_all();
+        for(auto&& t : workers) t.join();
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /**
+     * submit()
+     *
+     * @brief Queues f to run on a worker
+     * @return Future holding the result (or exception) of f
+     */
+    template<typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<F>>
+    {
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(f));
+        auto result = task->get_future();
+
+        auto i = (self_pool == this)? self_index : next++ % queues.size();
+        {
+            std::lock_guard lock{queues[i]->m};
+            queues[i]->tasks.emplace_back([task]{ (*task)(); });
+        }
+        { std::lock_guard lock{m}; ++queued; }
+        cv.notify_one();
+        return result;
+    }
+
+    std::size_t size() const { return workers.size(); }
+
+private:
+    struct Queue
+    {
+        std::mutex m{};
+        std::deque<std::function<void()>> tasks{};
+    };
+
+    //Newest task of worker i, otherwise the oldest task of another worker
+    std::optional<std::function<void()>> take(std::size_t i)
+    {
+        for(std::size_t k = 0; k < queues.size(); ++k)
+        {
+            auto& q = *queues[(i + k) % queues.size()];
+            std::lock_guard lock{q.m};
+            if(q.tasks.empty()) continue;
+
+            std::function<void()> task;
+            if(k == 0) { task = std::move(q.tasks.back());  q.tasks.pop_back();  }
+            else       { task = std::move(q.tasks.front()); q.tasks.pop_front(); }
+            --queued;
+            return task;
+        }
+        return std::nullopt;
+    }
+
+    void work(std::size_t i)
+    {
+        self_pool  = this;
+        self_index = i;
+        while(true)
+        {
+            if(auto task = take(i)) { (*task)(); continue; }
+
+            std::unique_lock lock{m};
+            cv.wait(lock, [this]{ return stop || queued > 0; });
+            if(stop && queued == 0) return; //Stopped and drained
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues{}; //One per worker
+    std::vector<std::thread> workers{};
+    std::atomic<std::ptrdiff_t> queued{0};        //Tasks waiting in any queue (may briefly dip below 0)
+    std::atomic<std::size_t> next{0};             //Round-robin queue for outside submissions
+    std::mutex m{};
+    std::condition_variable cv{};
+    bool stop{false};
+
+    //Pool and index of the worker running on this thread
+    static inline thread_local ThreadPool* self_pool{nullptr};
+    static inline thread_local std::size_t self_index{0};
+};